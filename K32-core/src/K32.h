@@ -10,18 +10,16 @@
 
 #include "K32_version.h"
 #include "K32_system.h"
+#include "K32_router.h"
 #include "utils/K32_timer.h"
 
 
 class K32
 {
-private:
-    K32_module* _modules[32];
-    int _moduleCount = 0;
-
 public:
 
     K32_intercom *intercom;
+    K32_router *router;
     K32_system *system;
     K32_timer* timer;
 
@@ -34,6 +32,8 @@ public:
         
         // INTERCOM
         intercom = new K32_intercom();
+        intercom->coalesce("leds/frame");
+        router = new K32_router();
 
         // SYSTEM
         system = new K32_system();
@@ -77,42 +77,41 @@ public:
     }
 
     void attach(K32_module* module) {
-        _modules[_moduleCount] = module;
-        _moduleCount += 1;
-
-        module->link(intercom);
+        module->link(intercom, router);
     }
     
+    // GET attached module, nullptr if not found
     K32_module* module(String name) {
-        for (int i=0; i<_moduleCount; i++)
-            if (_modules[i]->name() == name) return _modules[i];
-        LOG("K32: module "+name+" not found..");
-        return new K32_module("");
+        K32_module* mod = router->module(name.c_str());
+        if (mod == nullptr) LOG("K32: module "+name+" not found..");
+        return mod;
     }
 
     // EVENTS Register
     /////////////////////
 
     void on(const char *name, void (*cb)(Orderz* order)) {
-        this->intercom->ee->addListener(name, cb);
+        this->router->listen(name, cb);
     }
 
     void emit(Orderz* order) {
+        if (order == nullptr) return;
         order->isCmd = false;
       intercom->queue(order);
     }
 
     void emit(const char* command) {
-      intercom->queue(new Orderz(command, false));
+      intercom->queue(intercom->order(command, false));
     }
 
     void cmd(Orderz* order) {
+        if (order == nullptr) return;
         order->isCmd = true;
       intercom->queue(order);
     }
 
     void cmd(const char* command) {
-      intercom->queue(new Orderz(command, true));
+      intercom->queue(intercom->order(command, true));
     }
 
 
@@ -126,13 +125,23 @@ public:
             if (order->isCmd) {
                 LOGINL(" * ");
                 LOG(order->engine_action);
-                module(order->engine)->execute(order);
+
+                // registered route, or module generic command()
+                routeEntry* route = this->router->route(order);
+                if (route) route->handler(route->module, order);
+                else {
+                    K32_module* mod = this->router->module(order->engineKey, order->engine);
+                    if (mod) mod->execute(order);
+                    else {
+                        LOGINL("K32: module not found.. ");
+                        LOG(order->engine);
+                    }
+                }
             }
             else {
                 LOGINL(" - ");
                 LOG(order->engine_action);
-                this->intercom->ee->emit(order->engine, order);
-                this->intercom->ee->emit(order->engine_action, order);
+                this->router->emit(order);
             }
         }            
     }
@@ -148,7 +157,7 @@ public:
             // LOG("K32: order obtained");
             that->dispatch(nextOrder);
             // LOG("K32: order dispatched");
-            delete(nextOrder);
+            that->intercom->release(nextOrder);
         }
         vTaskDelete(NULL);
     }
@@ -8,47 +8,58 @@
 
 #include "Arduino.h"
 #include "utils/K32_log.h"
+#include "utils/K32_hash.h"
 #include "freertos/ringbuf.h"
-#include <EventEmitter.h>
 
-enum argType { INT, STR };
+#define ORDERZ_ARENA    512   // path + packed arguments, inline in each order
+#define ORDERZ_MAXARGS  32
+#define ORDERZ_MAXWORD  63    // engine / action / subaction max length
+
+enum argType : uint8_t { INT, STR, FLOAT, BLOB };
+
+// Argument record, packed in Orderz arena: [argX][payload]
+// payload is the string (STR), raw bytes (BLOB) or textual form of the number (INT, FLOAT)
 class argX
 { 
   public:
-    argX(int value) {
-      type = INT;
-      argInt = value;
-    }
-
-    argX(const char* value) {
-      type = STR;
-      argStr = (char *) malloc(strlen(value) + 1); 
-      strcpy(argStr, value);
-      strInited = true;
-    }
-
     argType type;
-    char* argStr;
-    int argInt = 0;
-    bool strInited = false;
+    uint16_t len;     // payload size (text including \0)
+    union {
+      int argInt;
+      float argFloat;
+    };
     
     int toInt() { 
-      if (type == STR) return atoi(argStr); 
+      if (type == STR) return atoi(payload()); 
+      if (type == FLOAT) return (int)argFloat;
+      if (type == BLOB) return 0;
       return argInt;
     }
+
+    float toFloat() { 
+      if (type == STR) return atof(payload()); 
+      if (type == INT) return argInt;
+      if (type == BLOB) return 0;
+      return argFloat;
+    }
+
+    // views into order arena: valid until order is set() / cleared
     const char* toStr() {
-      if (type == INT && !strInited) {
-        char str[33];
-        sprintf(str, "%d", argInt);
-        argStr = (char *) malloc(strlen(str) + 1); 
-        strcpy(argStr, str);
-        strInited = true;
-      }
-      return argStr; 
+      if (type == BLOB) return "";
+      return payload(); 
+    }
+
+    const uint8_t* blob() {
+      return reinterpret_cast<const uint8_t*>(payload());
+    }
+
+    int size() {
+      return len;
     }
 
-    ~argX() {
-      if (strInited) free(argStr);
+  private:
+    const char* payload() {
+      return reinterpret_cast<const char*>(this + 1);
     }
 };
 
@@ -56,9 +67,7 @@ class argX
 class Orderz 
 {
   public:
-    Orderz() {}
-
-    ~Orderz() {
+    Orderz() {
       clear();
     }
 
@@ -66,28 +75,71 @@ class Orderz
       set(command);
     }
 
-    Orderz* set(const char* command) {
+    // engine/action/subaction point into the arena: no copy
+    Orderz(const Orderz&) = delete;
+    Orderz& operator=(const Orderz&) = delete;
+
+    Orderz* set(const char* command) 
+    {
+      // re-set from own path
+      if (command >= _arena && command < _arena + ORDERZ_ARENA) {
+        char path[ORDERZ_MAXWORD*3+3];
+        strncpy(path, command, sizeof(path)-1);
+        path[sizeof(path)-1] = '\0';
+        return set(path);
+      }
+
       clear();
-      splitString(command, "/", 0, engine);
-      splitString(command, "/", 1, action);
-      splitString(command, "/", 2, subaction);
 
-      strcpy (engine_action, engine);
-      strcat (engine_action,"/");
-      strcat (engine_action, action);
+      // split engine/action/subaction (empty words are skipped)
+      const char* word[3];
+      int wordLen[3];
+      const char* c = command;
+      for (int w = 0; w < 3; w++) {
+        while (*c == '/') c++;
+        word[w] = c;
+        while (*c != '\0' && *c != '/') c++;
+        wordLen[w] = min((int)(c - word[w]), ORDERZ_MAXWORD);
+      }
+
+      // arena: engine\0action\0subaction\0engine/action\0
+      engine = put(word[0], wordLen[0]);
+      action = put(word[1], wordLen[1]);
+      subaction = put(word[2], wordLen[2]);
+      engine_action = put(word[0], wordLen[0]);
+      _used -= 1;
+      _arena[_used++] = '/';
+      put(word[1], wordLen[1]);
+      align();
+
+      // routing keys, hashed once here: engine, engine/action, engine/action/subaction
+      uint32_t h = k32hash(engine_action);
+      engineKey = k32key(k32hash(word[0], wordLen[0]));
+      actionKey = k32key(h);
+      if (wordLen[2] > 0) subKey = k32key(k32hash(word[2], wordLen[2], k32hash("/", 1, h)));
 
       workable = true;
       return this;
     }
 
     void addData(int value) {
-      data[dataCount] = new argX(value);
-      dataCount++;
+      char text[12];
+      argX* arg = add(INT, text, itoa(value, text));
+      if (arg) arg->argInt = value;
+    }
+
+    void addData(float value) {
+      char text[16];
+      argX* arg = add(FLOAT, text, snprintf(text, sizeof(text), "%g", value) + 1);
+      if (arg) arg->argFloat = value;
     }
 
     void addData(const char* value) {
-      data[dataCount] = new argX(value);
-      dataCount++;
+      add(STR, value, strlen(value) + 1);
+    }
+
+    void addData(const uint8_t* value, int size) {
+      add(BLOB, reinterpret_cast<const char*>(value), size);
     }
 
     int count() {
@@ -95,12 +147,18 @@ class Orderz
     }
 
     argX* getData(int index) {
-      return data[index];
+      if (index < 0 || index >= dataCount) {
+        static struct { argX arg; char text[4]; } none = {{INT, 1, {0}}, ""};   // out of range: 0 / "" 
+        return &none.arg;
+      }
+      return reinterpret_cast<argX*>(&_arena[_argOffset[index]]);
     }
 
     void clear() {
-      for (int k=0; k<dataCount; k++) delete(data[k]);
       dataCount = 0;
+      _used = 0;
+      engine = action = subaction = engine_action = "";
+      engineKey = actionKey = subKey = 0;
       workable = false;
     }
 
@@ -110,11 +168,15 @@ class Orderz
       return w;
     }
 
-    char engine[128];
-    char action[128];
-    char subaction[128];
+    const char* engine;
+    const char* action;
+    const char* subaction;
     
-    char engine_action[257];
+    const char* engine_action;
+
+    uint32_t engineKey = 0;     // k32key("engine")
+    uint32_t actionKey = 0;     // k32key("engine/action")
+    uint32_t subKey = 0;        // k32key("engine/action/subaction"), 0 if no subaction
 
     bool isCmd = false; // FALSE = Event, TRUE = Command
 
@@ -122,47 +184,241 @@ class Orderz
 
     bool workable = false;
     int dataCount = 0;
-    argX* data[16];
-    
-    void splitString(const char *data, const char *separator, int index, char *result)
+    uint16_t _used = 0;
+    uint16_t _argOffset[ORDERZ_MAXARGS];
+    alignas(4) char _arena[ORDERZ_ARENA];
+
+    // append string to arena, return its location
+    const char* put(const char* value, int len) {
+      char* dest = &_arena[_used];
+      memcpy(dest, value, len);
+      dest[len] = '\0';
+      _used += len + 1;
+      return dest;
+    }
+
+    void align() {
+      _used = (_used + 3) & ~3;
+    }
+
+    // append argument record
+    argX* add(argType type, const char* payload, int len) 
     {
-      char input[strlen(data)];
-      strcpy(input, data);
+      if (dataCount >= ORDERZ_MAXARGS || _used + sizeof(argX) + len > ORDERZ_ARENA) {
+        LOG("ORDERZ: no room left for argument");
+        return nullptr;
+      }
 
-      char *command = strtok(input, separator);
-      for (int k = 0; k < index; k++)
-        if (command != NULL)
-          command = strtok(NULL, separator);
+      argX* arg = reinterpret_cast<argX*>(&_arena[_used]);
+      arg->type = type;
+      arg->len = len;
+      arg->argInt = 0;
+      memcpy(&_arena[_used + sizeof(argX)], payload, len);
 
-      if (command == NULL) strcpy(result, "");
-      else strcpy(result, command);
+      _argOffset[dataCount++] = _used;
+      _used += sizeof(argX) + len;
+      align();
+      return arg;
     }
+
+    // decimal text of value, returns length including \0
+    static int itoa(int value, char* text) 
+    {
+      char digits[12];
+      int n = 0;
+      unsigned int v = (value < 0) ? -(unsigned int)value : value;
+      do {
+        digits[n++] = '0' + v % 10;
+        v /= 10;
+      } while (v);
+
+      int len = 0;
+      if (value < 0) text[len++] = '-';
+      while (n) text[len++] = digits[--n];
+      text[len++] = '\0';
+      return len;
+    }
+};
+
+#ifndef INTERCOM_DEPTH
+  #define INTERCOM_DEPTH      10    // orders waiting for dispatch
+#endif
+#ifndef INTERCOM_POOL
+  #define INTERCOM_POOL       16    // preallocated orders (queue + being filled + being dispatched)
+#endif
+#define INTERCOM_COALESCE     4     // max coalesced paths
+
+// What to do when the queue is full
+enum intercomPolicy { DROP_NEWEST, DROP_OLDEST };
+
+struct intercomStats {
+  uint32_t drops;         // orders dropped (queue full)
+  uint32_t coalesced;     // orders replaced by a newer one with same path
+  uint32_t exhausted;     // order requests refused (pool empty)
+  int highWater;          // max orders waiting in queue
 };
 
 class K32_intercom 
 {
   public:
-    K32_intercom() {
-        Orderz order;
-        orderzQueue = xQueueCreate( 10, sizeof(&order) );
-        ee = new EventEmitter<Orderz*>();
+    K32_intercom(int depth = INTERCOM_DEPTH, intercomPolicy policy = DROP_NEWEST) : _policy(policy) 
+    {
+        orderzQueue = xQueueCreate( depth, sizeof(queueItem) );
+        freeQueue = xQueueCreate( INTERCOM_POOL, sizeof(Orderz*) );
+        lock = xSemaphoreCreateMutex();
+
+        for (int k=0; k<INTERCOM_POOL; k++) {
+          Orderz* order = &_pool[k];
+          xQueueSend(freeQueue, (void*) &order, 0);
+        }
+      }
+
+    // GET order from pool, nullptr if pool is empty (never blocks)
+    Orderz* order(const char* command, bool isCmd = false) 
+    {
+      Orderz* order;
+      if (xQueueReceive(freeQueue, &order, 0) != pdTRUE) {
+        tally(_stats.exhausted);
+        return nullptr;
+      }
+      order->isCmd = isCmd;
+      return order->set(command);
+    }
+
+    // GIVE BACK order once dispatched (orders created with new are deleted)
+    void release(Orderz* order) 
+    {
+      if (order == nullptr) return;
+      if (order >= _pool && order < _pool + INTERCOM_POOL) {
+        order->clear();
+        xQueueSend(freeQueue, (void*) &order, 0);
+      }
+      else delete(order);
+    }
+
+    // Replace pending order with the same path instead of queueing it again (ex: "leds/frame")
+    void coalesce(const char* path) 
+    {
+      xSemaphoreTake(lock, portMAX_DELAY);
+      if (_coalesceCount < INTERCOM_COALESCE) {
+        strncpy(_coalesce[_coalesceCount].path, path, sizeof(_coalesce[0].path)-1);
+        _coalesce[_coalesceCount].path[sizeof(_coalesce[0].path)-1] = '\0';
+        _coalesce[_coalesceCount].pending = nullptr;
+        _coalesceCount += 1;
       }
+      else LOG("INTERCOM: no more coalesce slot");
+      xSemaphoreGive(lock);
+    }
+
+    void policy(intercomPolicy p) {
+      _policy = p;
+    }
 
-    void queue(Orderz* order)
+    // QUEUE order (never blocks), returns false if order has been dropped
+    bool queue(Orderz* order)
     {
-      xQueueSend(orderzQueue, (void*) &order, portMAX_DELAY);
+      if (order == nullptr) return false;
+
+      queueItem item = {order, -1};
+
+      // COALESCE: replace pending order, or queue a reference to the slot
+      xSemaphoreTake(lock, portMAX_DELAY);
+      for (int k=0; k<_coalesceCount; k++)
+        if (strcmp(_coalesce[k].path, order->engine_action) == 0) 
+        {
+          Orderz* old = _coalesce[k].pending;
+          _coalesce[k].pending = order;
+          if (old) {
+            _stats.coalesced += 1;
+            xSemaphoreGive(lock);
+            release(old);
+            return true;
+          }
+          item.order = nullptr;
+          item.slot = k;
+          break;
+        }
+      xSemaphoreGive(lock);
+
+      // FULL: make room or drop
+      if (xQueueSend(orderzQueue, (void*) &item, 0) != pdTRUE) 
+      {
+        queueItem oldest;
+        if (_policy == DROP_OLDEST && xQueueReceive(orderzQueue, &oldest, 0) == pdTRUE) {
+          release(take(oldest));
+          tally(_stats.drops);
+        }
+        if (xQueueSend(orderzQueue, (void*) &item, 0) != pdTRUE) {
+          release(take(item));
+          tally(_stats.drops);
+          return false;
+        }
+      }
+
+      int waiting = uxQueueMessagesWaiting(orderzQueue);
+      xSemaphoreTake(lock, portMAX_DELAY);
+      if (waiting > _stats.highWater) _stats.highWater = waiting;
+      xSemaphoreGive(lock);
+      return true;
     }
 
     Orderz* next() {
-      Orderz* nextOrder;
-      xQueueReceive(orderzQueue, &(nextOrder), portMAX_DELAY);
+      queueItem item;
+      Orderz* nextOrder = nullptr;
+      while (nextOrder == nullptr) {
+        xQueueReceive(orderzQueue, &item, portMAX_DELAY);
+        nextOrder = take(item);
+      }
       return nextOrder;
     }
 
-    EventEmitter<Orderz*>* ee;
+    intercomStats stats() {
+      xSemaphoreTake(lock, portMAX_DELAY);
+      intercomStats copy = _stats;
+      xSemaphoreGive(lock);
+      return copy;
+    }
 
   private:
+
+    struct queueItem {
+      Orderz* order;
+      int slot;       // coalesce slot (order is pending in slot)
+    };
+
+    struct coalesceSlot {
+      char path[32];
+      Orderz* pending;
+    };
+
     QueueHandle_t orderzQueue;
+    QueueHandle_t freeQueue;
+    SemaphoreHandle_t lock;
+
+    intercomPolicy _policy;
+    intercomStats _stats = {0, 0, 0, 0};      // updated and copied under lock (several producer tasks)
+
+    Orderz _pool[INTERCOM_POOL];
+
+    coalesceSlot _coalesce[INTERCOM_COALESCE];
+    int _coalesceCount = 0;
+
+    // count one more drop / exhausted request
+    void tally(uint32_t& counter) {
+      xSemaphoreTake(lock, portMAX_DELAY);
+      counter += 1;
+      xSemaphoreGive(lock);
+    }
+
+    // order referenced by queue item (pending coalesced order is taken out of its slot)
+    Orderz* take(queueItem item) {
+      if (item.slot < 0) return item.order;
+      xSemaphoreTake(lock, portMAX_DELAY);
+      Orderz* order = _coalesce[item.slot].pending;
+      _coalesce[item.slot].pending = nullptr;
+      xSemaphoreGive(lock);
+      return order;
+    }
     
 };
 
@@ -0,0 +1,178 @@
+/*
+  K32_router.h
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+*/
+#ifndef K32_router_h
+#define K32_router_h
+
+#include "K32_intercom.h"
+
+#define ROUTER_ROUTES       128   // engine/action[/subaction] handlers (power of 2)
+#define ROUTER_LISTENERS    32    // event listeners (power of 2)
+#define ROUTER_MODULES      32    // attached modules (power of 2)
+
+class K32_module;
+
+typedef void (*routeHandler)(K32_module* module, Orderz* order);
+typedef void (*listenerCallback)(Orderz* order);
+
+struct routeEntry {
+  uint32_t key;
+  K32_module* module;
+  routeHandler handler;
+  String path;            // engine/action[/subaction]: checked on key hit
+};
+
+struct listenerEntry {
+  uint32_t key;
+  listenerCallback cb;
+  String name;            // engine or engine/action
+};
+
+struct moduleEntry {
+  uint32_t key;
+  K32_module* module;
+  String name;
+};
+
+//
+// Hashed tables (open addressing, linear probing) filled at attach time,
+// looked up by dispatch with the keys computed when the order was parsed.
+// Written from setup, read from the K32 run task: an entry is published by writing its key last.
+// Keys are 32 bit hashes: registered names are kept, a key hit is confirmed by comparing them
+// (an unknown path hashing as a registered one is not dispatched to it),
+// and registering a name whose key is already taken by another name is refused (logged).
+//
+class K32_router
+{
+  public:
+
+    // MODULE: engine name -> module (fallback to module->command())
+    void module(const char* name, K32_module* module)
+    {
+      uint32_t key = k32key(name);
+      int k = slot(_modules, ROUTER_MODULES, key);
+      if (k < 0) { LOG("ROUTER: no more module slot"); return; }
+      if (_modules[k].key && collides(_modules[k].name, name)) return;
+      _modules[k].module = module;
+      _modules[k].name = name;
+      _modules[k].key = key;
+    }
+
+    K32_module* module(const char* name) {
+      return module(k32key(name), name);
+    }
+
+    K32_module* module(uint32_t key, const char* name) {
+      int k = find(_modules, ROUTER_MODULES, key);
+      if (k < 0 || !matches(_modules[k].name, name)) return nullptr;
+      return _modules[k].module;
+    }
+
+    // ROUTE: engine/action[/subaction] -> handler (registering same path again replaces handler)
+    void route(const char* path, K32_module* module, routeHandler handler)
+    {
+      uint32_t key = k32key(path);
+      int k = slot(_routes, ROUTER_ROUTES, key);
+      if (k < 0) { LOG("ROUTER: no more route slot"); return; }
+      if (_routes[k].key && collides(_routes[k].path, path)) return;
+      _routes[k].module = module;
+      _routes[k].handler = handler;
+      _routes[k].path = path;
+      _routes[k].key = key;
+    }
+
+    // most specific route for order: engine/action/subaction, then engine/action
+    routeEntry* route(Orderz* order)
+    {
+      int k = -1;
+      if (order->subKey) {
+        k = find(_routes, ROUTER_ROUTES, order->subKey);
+        if (k >= 0 && !matches(_routes[k].path, order->engine_action, order->subaction)) k = -1;
+      }
+      if (k < 0) {
+        k = find(_routes, ROUTER_ROUTES, order->actionKey);
+        if (k >= 0 && !matches(_routes[k].path, order->engine_action)) k = -1;
+      }
+      return (k < 0) ? nullptr : &_routes[k];
+    }
+
+    // LISTENER: several callbacks can listen to the same event
+    void listen(const char* name, listenerCallback cb)
+    {
+      uint32_t key = k32key(name);
+      for (int i=0; i<ROUTER_LISTENERS; i++) {
+        int k = (key + i) & (ROUTER_LISTENERS-1);
+        if (_listeners[k].key == 0) {
+          _listeners[k].cb = cb;
+          _listeners[k].name = name;
+          _listeners[k].key = key;
+          return;
+        }
+        if (_listeners[k].key == key && collides(_listeners[k].name, name)) return;
+      }
+      LOG("ROUTER: no more listener slot");
+    }
+
+    // EMIT event to "engine" then "engine/action" listeners
+    void emit(Orderz* order) {
+      emit(order->engineKey, order->engine, order);
+      emit(order->actionKey, order->engine_action, order);
+    }
+
+  private:
+    routeEntry _routes[ROUTER_ROUTES] = {};
+    listenerEntry _listeners[ROUTER_LISTENERS] = {};
+    moduleEntry _modules[ROUTER_MODULES] = {};
+
+    void emit(uint32_t key, const char* name, Orderz* order)
+    {
+      for (int i=0; i<ROUTER_LISTENERS; i++) {
+        int k = (key + i) & (ROUTER_LISTENERS-1);
+        if (_listeners[k].key == 0) return;
+        if (_listeners[k].key == key && matches(_listeners[k].name, name)) _listeners[k].cb(order);
+      }
+    }
+
+    // registered name is name, or name + "/" + sub
+    static bool matches(const String& registered, const char* name, const char* sub = nullptr)
+    {
+      const char* r = registered.c_str();
+      int len = strlen(name);
+      if (strncmp(r, name, len) != 0) return false;
+      if (sub == nullptr) return r[len] == '\0';
+      return r[len] == '/' && strcmp(r + len + 1, sub) == 0;
+    }
+
+    // key already used by another name: refused
+    static bool collides(const String& registered, const char* name)
+    {
+      if (matches(registered, name)) return false;
+      LOGF2("ROUTER: ERROR %s has the same hash as %s, not registered\n", name, registered.c_str());
+      return true;
+    }
+
+    // index of key, -1 if absent
+    template<class T> static int find(T* table, int size, uint32_t key)
+    {
+      for (int i=0; i<size; i++) {
+        int k = (key + i) & (size-1);
+        if (table[k].key == key) return k;
+        if (table[k].key == 0) return -1;
+      }
+      return -1;
+    }
+
+    // index of key, or of first free slot where to insert it, -1 if table is full
+    template<class T> static int slot(T* table, int size, uint32_t key)
+    {
+      for (int i=0; i<size; i++) {
+        int k = (key + i) & (size-1);
+        if (table[k].key == key || table[k].key == 0) return k;
+      }
+      return -1;
+    }
+};
+
+#endif
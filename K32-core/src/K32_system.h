@@ -21,6 +21,19 @@ class K32_system : K32_module {
       preferences.begin("k32-app", false);
       xSemaphoreGive(this->lock);
 
+      // COMMANDS
+      route("reset",    [](K32_module* m, Orderz* o){ ((K32_system*)m)->reset(); });
+      route("shutdown", [](K32_module* m, Orderz* o){ ((K32_system*)m)->shutdown(); });
+      route("channel",  [](K32_module* m, Orderz* o)
+      {
+          if (o->count() < 1) return;
+          byte chan = o->getData(0)->toInt();
+          if (chan > 0) {
+            ((K32_system*)m)->channel(chan);
+            delay(100);
+            ((K32_system*)m)->reset();
+          }
+      });
     };
 
     int id() {
@@ -114,29 +127,6 @@ class K32_system : K32_module {
       return LEDS_PIN[hw()][i];
     }
 
-    // EXECUTE standardized command
-    void command(Orderz* order) 
-    {
-      // RESET
-      if (strcmp(order->action, "reset") == 0) 
-          this->reset();
-
-      // SHUTDOWN
-      else if (strcmp(order->action, "shutdown") == 0) 
-          this->shutdown();
-
-      // SET CHANNEL
-      else if (strcmp(order->action, "channel") == 0)
-      {
-          if (order->count() < 1) return;
-          byte chan = order->getData(0)->toInt();
-          if (chan > 0) {
-            this->channel(chan);
-            delay(100);
-            this->reset();
-          }
-      }
-    }
     Preferences preferences;
     
   private:
@@ -8,6 +8,9 @@
 #define K32_module_h
 
 #include "K32_intercom.h"
+#include "K32_router.h"
+
+#define MODULE_PENDING_ROUTES   16    // routes declared before the module is attached
 
 class K32_module {
   public:
@@ -15,6 +18,8 @@ class K32_module {
         _name = name;
     }
 
+    virtual ~K32_module() {}
+
     // GET Name
     String name() {
         return _name;
@@ -24,43 +29,77 @@ class K32_module {
     virtual void command( Orderz* order ) {
     }
 
+    // STATUS report, appended to network status (see K32_osc::statusMsg, K32_mqtt beacon)
+    virtual String status() {
+      return "";
+    }
+
     // EXECUTE specific callback
     void execute(Orderz* order) {
       command(order);
     }
 
-    // LINK intercom
-    void link(K32_intercom *i) {
+    // LINK intercom and router (routes declared so far are registered now)
+    void link(K32_intercom *i, K32_router *r) {
       intercom = i;
+      router = r;
+      router->module(_name.c_str(), this);
+      for (int k=0; k<_pendingCount; k++) 
+        router->route(_pending[k].path.c_str(), this, _pending[k].handler);
+      _pendingCount = 0;
+    }
+
+    // ROUTE command "name/path" to handler, path is action[/subaction]
+    // ex: route("master/less", [](K32_module* m, Orderz* o){ ... });
+    void route(const char* path, routeHandler handler) 
+    {
+      String full = _name + "/" + path;
+
+      if (router != nullptr) router->route(full.c_str(), this, handler);
+      else if (_pendingCount < MODULE_PENDING_ROUTES) {
+        _pending[_pendingCount].path = full;
+        _pending[_pendingCount].handler = handler;
+        _pendingCount += 1;
+      }
+      else LOG("ERROR: module has too many pending routes");
     }
 
     // EVENTS Register
     /////////////////////
 
+    // GET empty order from intercom pool (nullptr if pool is exhausted)
+    Orderz* order(const char* command) {
+      if (intercom != nullptr) return intercom->order(command);
+      LOG("ERROR: module ot linked to intercom");
+      return nullptr;
+    }
+
     void emit(Orderz* order) {
+      if (order == nullptr) return;
       order->isCmd = false;
       if (intercom != nullptr) intercom->queue(order);
       else LOG("ERROR: module ot linked to intercom");
     }
 
     void emit(const char* command) {
-      if (intercom != nullptr) intercom->queue(new Orderz(command, false));
+      if (intercom != nullptr) intercom->queue(intercom->order(command, false));
       else LOG("ERROR: module ot linked to intercom");
     }
 
     void cmd(Orderz* order) {
+      if (order == nullptr) return;
       order->isCmd = true;
       if (intercom != nullptr) intercom->queue(order);
       else LOG("ERROR: module ot linked to intercom");
     }
 
     void cmd(const char* command) {
-      if (intercom != nullptr) intercom->queue(new Orderz(command, true));
+      if (intercom != nullptr) intercom->queue(intercom->order(command, true));
       else LOG("ERROR: module ot linked to intercom");
     }
 
     void on(const char *name, void (*cb)(Orderz* order)) {
-      if (intercom != nullptr)  intercom->ee->addListener(name, cb);
+      if (router != nullptr)  router->listen(name, cb);
       else LOG("ERROR: module ot linked to intercom");
     }
 
@@ -70,7 +109,11 @@ class K32_module {
 
   private:
     K32_intercom *intercom = nullptr;
-    
+    K32_router *router = nullptr;
+
+    struct { String path; routeHandler handler; } _pending[MODULE_PENDING_ROUTES];
+    int _pendingCount = 0;
+
 };
 
 #endif
@@ -18,6 +18,15 @@ class K32_pwm : K32_plugin {
     K32_pwm(K32* k32) : K32_plugin("pwm", k32)
     {
       for(int k=0; k<PWM_MAXCHANNELS; k++) this->chanState[k] = 0;
+
+      // COMMANDS
+      route("blackout", [](K32_module* m, Orderz* o){ ((K32_pwm*)m)->blackout(); });
+      route("all",      [](K32_module* m, Orderz* o){ 
+        if (o->count() == 1) ((K32_pwm*)m)->setAll(o->getData(0)->toInt()); 
+      });
+      route("set",      [](K32_module* m, Orderz* o){ 
+        if (o->count() == 2) ((K32_pwm*)m)->set(o->getData(0)->toInt(), o->getData(1)->toInt()); 
+      });
     };
 
 
@@ -63,24 +72,6 @@ class K32_pwm : K32_plugin {
     }
 
 
-    void command(Orderz* order)
-    {
-      // BLACK
-      if (strcmp(order->action, "blackout") == 0)  this->blackout();
-
-      // ALL
-      else if (strcmp(order->action, "all") == 0)  {
-        if (order->count() == 1) 
-          this->setAll(order->getData(0)->toInt());
-      }
-
-      // SET
-      else if (strcmp(order->action, "set") == 0) {
-        if (order->count() == 2) 
-          this->set( order->getData(0)->toInt(), order->getData(1)->toInt() );
-      }
-    }
-
   private:
     int chanState[PWM_MAXCHANNELS];
     byte chanNumber = 0;
@@ -0,0 +1,160 @@
+/*
+  K32_clock.h
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+*/
+#ifndef K32_clock_h
+#define K32_clock_h
+
+#include <Arduino.h>
+#include <atomic>
+#include "K32_log.h"
+
+#define CLOCK_WINDOW      8         // beacons per estimation window: the least delayed one is kept
+#define CLOCK_BASELINE    60000     // ms between two drift measures
+#define CLOCK_STEP        50        // ms: larger error is a new master (or a reboot), clock jumps
+
+//
+// SHOW CLOCK: local millis() corrected by offset and drift to follow a master clock.
+// Master beacons (see K32_osc: /clock) carry master show time, the least delayed sample of each
+// window gives the offset (network delay only adds to it), offsets CLOCK_BASELINE apart give the drift.
+// Lock-free for readers: estimate is published with a sequence counter (one writer: the beacon receiver).
+//
+class K32_clock {
+  public:
+
+    // show time (ms): local millis() until first beacon
+    uint32_t now() {
+      return this->at(millis());
+    }
+
+    // show time at local time
+    uint32_t at(uint32_t local) {
+      return this->predict(this->snapshot(), local);
+    }
+
+    // master beacon: masterTime (show time when sent) received at local time
+    void beacon(uint32_t masterTime, uint32_t local)
+    {
+      int32_t sample = (int32_t)(masterTime - local);
+
+      // FIRST beacon: follow it right away, refined by next windows
+      if (!this->_est.synced) {
+        this->_est = {local, sample, 0, true};
+        this->_anchorLocal = local;
+        this->_anchorOffset = sample;
+        this->publish();
+        return;
+      }
+
+      // WINDOW: keep least delayed sample (highest offset)
+      if (this->_count == 0 || sample > this->_best) {
+        this->_best = sample;
+        this->_bestLocal = local;
+      }
+      if (++this->_count < CLOCK_WINDOW) return;
+      this->_count = 0;
+
+      // OFFSET: smooth window best against prediction, jump if too far
+      int32_t predicted = (int32_t)(this->predict(this->_est, this->_bestLocal) - this->_bestLocal);
+      int32_t error = this->_best - predicted;
+      if (abs(error) > CLOCK_STEP) {
+        LOGF("CLOCK: jump %d ms\n", (int)error);
+        this->_est = {this->_bestLocal, this->_best, 0, true};
+        this->_anchorLocal = this->_bestLocal;
+        this->_anchorOffset = this->_best;
+        this->_drifted = false;
+        this->publish();
+        return;
+      }
+      int32_t offset = predicted + error/2;
+
+      // DRIFT: offset slope over baseline (ppm), averaged with previous measure
+      int32_t drift = this->_est.drift;
+      uint32_t elapsed = this->_bestLocal - this->_anchorLocal;
+      if (elapsed >= CLOCK_BASELINE) {
+        int32_t slope = ((int64_t)(offset - this->_anchorOffset) * 1000000) / (int64_t)elapsed;
+        drift = (this->_drifted) ? (drift + slope) / 2 : slope;
+        this->_drifted = true;
+        this->_anchorLocal = this->_bestLocal;
+        this->_anchorOffset = offset;
+      }
+
+      this->_est = {this->_bestLocal, offset, drift, true};
+      this->publish();
+    }
+
+    // forget master: back to local millis()
+    void reset() {
+      this->_est = {0, 0, 0, false};
+      this->_count = 0;
+      this->_drifted = false;
+      this->publish();
+    }
+
+    bool synced()   { return this->snapshot().synced; }
+    int drift()     { return this->snapshot().drift; }      // ppm
+
+    // show - local (ms)
+    int offset() {
+      uint32_t local = millis();
+      return (int32_t)(this->at(local) - local);
+    }
+
+  private:
+
+    struct clockEstimate {
+      uint32_t local;       // estimate reference (local ms)
+      int32_t offset;       // show - local at reference (ms)
+      int32_t drift;        // show clock speed vs local (ppm)
+      bool synced;
+    };
+
+    uint32_t predict(const clockEstimate& e, uint32_t local) {
+      int32_t elapsed = (int32_t)(local - e.local);
+      return local + e.offset + (int32_t)(((int64_t)elapsed * e.drift) / 1000000);
+    }
+
+    // READERS: last published estimate (a publish is a few stores: retry)
+    clockEstimate snapshot() 
+    {
+      clockEstimate e;
+      uint32_t seq;
+      do {
+        seq = this->_seq.load(std::memory_order_acquire);
+        e = this->_shared;
+        std::atomic_thread_fence(std::memory_order_acquire);
+      }
+      while ((seq & 1) || this->_seq.load(std::memory_order_relaxed) != seq);
+      return e;
+    }
+
+    void publish() {
+      uint32_t seq = this->_seq.load(std::memory_order_relaxed);
+      this->_seq.store(seq + 1, std::memory_order_relaxed);       // odd: publish in progress
+      std::atomic_thread_fence(std::memory_order_release);
+      this->_shared = this->_est;
+      this->_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // writer (beacon receiver)
+    clockEstimate _est = {0, 0, 0, false};
+    int _count = 0;
+    int32_t _best = 0;
+    uint32_t _bestLocal = 0;
+    uint32_t _anchorLocal = 0;
+    int32_t _anchorOffset = 0;
+    bool _drifted = false;
+
+    // readers
+    clockEstimate _shared = {0, 0, 0, false};
+    std::atomic<uint32_t> _seq {0};
+};
+
+// SHOW CLOCK of this node (modulators time, render frame phase)
+inline K32_clock& showClock() {
+  static K32_clock clock;
+  return clock;
+}
+
+#endif
@@ -0,0 +1,37 @@
+/*
+  K32_hash.h
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+*/
+#ifndef K32_hash_h
+#define K32_hash_h
+
+#include <stdint.h>
+#include <string.h>
+
+// FNV-1a, incremental: k32hash("leds/master") == k32hash("master", 6, k32hash("leds/", 5))
+#define K32_HASH_SEED   2166136261u
+
+inline uint32_t k32hash(const char* str, int len, uint32_t h = K32_HASH_SEED)
+{
+  for (int i=0; i<len; i++) {
+    h ^= (uint8_t)str[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+inline uint32_t k32hash(const char* str) {
+  return k32hash(str, strlen(str));
+}
+
+// Routing key: 0 is reserved (empty slot / no key)
+inline uint32_t k32key(uint32_t h) {
+  return (h == 0) ? 1 : h;
+}
+
+inline uint32_t k32key(const char* path) {
+  return k32key(k32hash(path));
+}
+
+#endif
@@ -0,0 +1,369 @@
+/*
+  k32bench.cpp
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Frame cost of every animation and modulator, on a simulated fixture:
+    ./k32bench [-n frames] [-b] [filter]
+
+    -b      buffered fixture (as with K32_light::pipeline)
+    filter  only run benchmarks whose name contains filter
+
+  One frame is what the render task does per anim: modulate() then render(),
+  render is forced every frame (worst case: anim paused or idle would skip it).
+  allocs/frame counts malloc / new on the benchmark thread.
+
+  Fixture writes: a whole frame drawn pixel by pixel, pix() taking buffer_lock for each pixel
+  vs lock-free writes to the back frame published once by unlock() (see K32_fixture::buffered).
+
+  Spans: packed color kernels (_libfast/swar.h) vs the same op with CRGBW, pixel by pixel
+  (bit-exactness: tests/test_swar.cpp). make SCALAR=1 builds the per-channel reference kernels.
+
+  Waves: level of each pixel of a spatial modulator, fixed point waveform (_libfast/wave16.h)
+  vs the float formula modulators used before (golden values: tests/test_wave16.cpp).
+  The host FPU runs the float triangle as fast as triangle16, the gain is on sinf.
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include "K32_light.h"
+
+#define BENCH_FRAMES    2000
+#define BENCH_WARMUP    50
+
+static const int benchSizes[] = {60, 144, 300, 512};
+
+
+//
+// ALLOCATIONS: glibc malloc wrapped, counted on benchmark thread only
+//
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static thread_local bool countAllocs = false;
+static thread_local uint32_t allocs = 0;
+
+extern "C" void* malloc(size_t size) {
+  if (countAllocs) allocs++;
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t n, size_t size) {
+  if (countAllocs) allocs++;
+  return __libc_calloc(n, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+  if (countAllocs) allocs++;
+  return __libc_realloc(ptr, size);
+}
+
+
+//
+// BENCHMARKS
+//
+
+typedef std::chrono::steady_clock benchClock;
+
+static uint64_t nanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(benchClock::now().time_since_epoch()).count();
+}
+
+struct benchCase {
+  const char* name;
+  K32_anim* (*make)(K32_fixture* fix);
+};
+
+// anims: one per animations/*.h, with representative data
+static K32_anim* animTest(K32_fixture* fix) {
+  return (new K32_anim_test())->setup(fix)->push(100);
+}
+static K32_anim* animColor(K32_fixture* fix) {
+  return (new K32_anim_color())->setup(fix)->push(255, 128, 0, 20);
+}
+static K32_anim* animCharge(K32_fixture* fix) {
+  return (new K32_anim_charge())->setup(fix)->push(60, 150);
+}
+static K32_anim* animDischarge(K32_fixture* fix) {
+  return (new K32_anim_discharge())->setup(fix)->push(60, 150);
+}
+
+// modulators: on a color anim, all color slots (spatial: spread along the fixture)
+template<typename M>
+static K32_anim* modScalar(K32_fixture* fix) {
+  K32_anim* anim = animColor(fix);
+  anim->mod(new M)->at(0)->at(1)->at(2)->at(3)->period(1000);
+  return anim;
+}
+template<typename M>
+static K32_anim* modSpatial(K32_fixture* fix) {
+  K32_anim* anim = animColor(fix);
+  anim->mod(new M)->period(1000)->wavelength(fix->size()/4);
+  return anim;
+}
+template<typename M, int N>
+static K32_anim* modStack(K32_fixture* fix) {
+  K32_anim* anim = animColor(fix);
+  for (int k=0; k<N; k++) anim->mod(new M)->at(k%4)->period(500 + 250*k);
+  return anim;
+}
+
+// NOTE: new animations (animations/*.h) and modulators (K32_mods.h) should be added here
+static const benchCase benchCases[] = {
+  {"anim/test",             animTest},
+  {"anim/color",            animColor},
+  {"anim/charge",           animCharge},
+  {"anim/discharge",        animDischarge},
+
+  {"mod/sinus",             modScalar<K32_mod_sinus>},
+  {"mod/triangle",          modScalar<K32_mod_triangle>},
+  {"mod/sawtooth",          modScalar<K32_mod_sawtooth>},
+  {"mod/isawtooth",         modScalar<K32_mod_isawtooth>},
+  {"mod/pulse",             modScalar<K32_mod_pulse>},
+  {"mod/multipulse",        modScalar<K32_mod_multipulse>},
+  {"mod/random",            modScalar<K32_mod_random>},
+  {"mod/fadein",            modScalar<K32_mod_fadein>},
+  {"mod/fadeout",           modScalar<K32_mod_fadeout>},
+
+  {"spatial/sinus",         modSpatial<K32_mod_sinus>},
+  {"spatial/triangle",      modSpatial<K32_mod_triangle>},
+  {"spatial/random",        modSpatial<K32_mod_random>},
+
+  {"stack/sinus x8",        modStack<K32_mod_sinus, 8>},
+  {"stack/random x8",       modStack<K32_mod_random, 8>},
+};
+
+// FIXTURE WRITES: one frame drawn pixel by pixel (as K32_anim_charge), per-pixel lock vs back frame + publish
+static uint64_t frameLocked(K32_fixture* fix, int frames)
+{
+  uint64_t t0 = nanos();
+  for (int f=0; f<frames; f++) 
+    for (int i=0; i<fix->size(); i++) fix->pix(i, pixelFromRGBW(f, i, 0, 0));
+  return nanos() - t0;
+}
+
+static uint64_t framePublished(K32_fixture* fix, int frames)
+{
+  uint64_t t0 = nanos();
+  for (int f=0; f<frames; f++) {
+    fix->lock();
+    pixelColor_t* frame = fix->frame();
+    for (int i=0; i<fix->size(); i++) frame[i] = pixelFromRGBW(f, i, 0, 0);
+    fix->touch(0, fix->size());
+    fix->unlock();
+  }
+  return nanos() - t0;
+}
+
+struct writeCase {
+  const char* name;
+  bool buffered;
+  uint64_t (*run)(K32_fixture* fix, int frames);
+};
+
+static const writeCase writeCases[] = {
+  {"fixture/pix lock",      false,  frameLocked},
+  {"fixture/publish",       true,   framePublished},
+};
+
+// SPANS: packed kernels (_libfast/swar.h) vs per-channel CRGBW loop, on a whole fixture frame
+static pixelColor_t spanDst[FIXTURE_MAXPIXEL], spanSrc[FIXTURE_MAXPIXEL];
+
+static void spanVideo(int n, uint8_t s)           { spanScaleVideo(spanDst, n, s); }
+static void spanVideoRef(int n, uint8_t s)        { for (int i=0; i<n; i++) spanDst[i] = CRGBW(spanDst[i]) %= s; }
+static void spanFadeOp(int n, uint8_t s)          { spanFade(spanDst, n, s); }
+static void spanFadeRef(int n, uint8_t s)         { for (int i=0; i<n; i++) spanDst[i] = CRGBW(spanDst[i]).fadeToBlackBy(s); }
+static void spanAddOp(int n, uint8_t s)           { spanAdd(spanDst, spanSrc, n); }
+static void spanAddRef(int n, uint8_t s)          { for (int i=0; i<n; i++) spanDst[i] = CRGBW(spanDst[i]) += CRGBW(spanSrc[i]); }
+static void spanMaxOp(int n, uint8_t s)           { spanMax(spanDst, spanSrc, n); }
+static void spanMaxRef(int n, uint8_t s)          { for (int i=0; i<n; i++) spanDst[i] = CRGBW(spanDst[i]) |= CRGBW(spanSrc[i]); }
+static void spanLerpOp(int n, uint8_t s)          { spanLerp(spanDst, spanSrc, n, s); }
+static void spanLerpRef(int n, uint8_t s)         { for (int i=0; i<n; i++) spanDst[i] = CRGBW(spanDst[i]).lerp8(CRGBW(spanSrc[i]), s); }
+
+struct spanCase {
+  const char* name;
+  void (*packed)(int count, uint8_t s);
+  void (*reference)(int count, uint8_t s);
+};
+
+static const spanCase spanCases[] = {
+  {"span/video",    spanVideo,    spanVideoRef},      // master dimming
+  {"span/fade",     spanFadeOp,   spanFadeRef},
+  {"span/add",      spanAddOp,    spanAddRef},
+  {"span/max",      spanMaxOp,    spanMaxRef},
+  {"span/lerp",     spanLerpOp,   spanLerpRef},       // crossfade
+};
+
+static uint64_t spanRun(void (*op)(int, uint8_t), int count, int frames)
+{
+  for (int i=0; i<count; i++) { spanDst[i].num = random(0x7FFFFFFF) * 2 + 1; spanSrc[i].num = random(0x7FFFFFFF); }
+  uint64_t t0 = nanos();
+  for (int f=0; f<frames; f++) op(count, 200 + (f & 31));
+  return nanos() - t0;
+}
+
+// WAVES: one level per pixel (as K32_modulator::spread), fixed point vs float, phase step of a 4 pixels wavelength
+static volatile uint8_t waveLevel[FIXTURE_MAXPIXEL];      // volatile: every frame is written
+
+static void waveSine16(int n, uint16_t phase)     { for (int i=0; i<n; i++, phase -= 16384) waveLevel[i] = scale16level(sine16(phase), 190) + 10; }
+static void waveSineRef(int n, uint16_t phase)    { for (int i=0; i<n; i++, phase -= 16384) waveLevel[i] = (0.5f + 0.5f * sinf(2 * PI * (phase / 65536.0f))) * 190 + 10; }
+static void waveTri16(int n, uint16_t phase)      { for (int i=0; i<n; i++, phase -= 16384) waveLevel[i] = scale16level(triangle16(phase), 190) + 10; }
+static void waveTriRef(int n, uint16_t phase)     { 
+  for (int i=0; i<n; i++, phase -= 16384) {
+    float percent = phase / 65536.0f;
+    if (percent > 0.5) percent = 1 - percent;
+    waveLevel[i] = 2 * percent * 190 + 10;
+  }
+}
+
+struct waveCase {
+  const char* name;
+  void (*fixed)(int count, uint16_t phase);
+  void (*reference)(int count, uint16_t phase);
+};
+
+static const waveCase waveCases[] = {
+  {"wave/sinus",    waveSine16,   waveSineRef},
+  {"wave/triangle", waveTri16,    waveTriRef},
+};
+
+static uint64_t waveRun(void (*op)(int, uint16_t), int count, int frames)
+{
+  uint64_t t0 = nanos();
+  for (int f=0; f<frames; f++) op(count, f * 97);
+  return nanos() - t0;
+}
+
+struct benchResult {
+  uint64_t modulate;      // ns
+  uint64_t render;        // ns
+  uint32_t allocs;
+};
+
+static benchResult run(const benchCase& c, K32_fixture* fix, int frames)
+{
+  K32_anim* anim = c.make(fix);
+  anim->play();
+
+  benchResult r = {0, 0, 0};
+  for (int f=0; f<BENCH_WARMUP+frames; f++)
+  {
+    bool measure = (f >= BENCH_WARMUP);
+    if (measure) countAllocs = true;
+
+    uint64_t t0 = nanos();
+    anim->modulate();
+    uint64_t t1 = nanos();
+    anim->render();
+    uint64_t t2 = nanos();
+
+    countAllocs = false;
+    anim->loop(true);                 // keep one-shot anims (test) drawing
+    if (!measure) continue;
+    r.modulate += t1 - t0;
+    r.render += t2 - t1;
+  }
+  r.allocs = allocs;
+  allocs = 0;
+
+  anim->unmod(true);
+  delete anim;
+  return r;
+}
+
+int main(int argc, char** argv)
+{
+  int frames = BENCH_FRAMES;
+  bool buffered = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:b")) != -1)
+    switch (opt) {
+      case 'n': frames = max(1, atoi(optarg)); break;
+      case 'b': buffered = true; break;
+      default:
+        fprintf(stderr, "usage: %s [-n frames] [-b] [filter]\n", argv[0]);
+        return 1;
+    }
+  const char* filter = (optind < argc) ? argv[optind] : "";
+
+  setenv("K32_HOST_QUIET", "1", 0);     // anims log on play / end
+  Serial.begin(115200);
+
+  K32_fixture* fixtures[sizeof benchSizes / sizeof benchSizes[0]];
+  for (int s=0; s<(int)(sizeof benchSizes / sizeof benchSizes[0]); s++) {
+    fixtures[s] = new K32_fixture(benchSizes[s]);
+    fixtures[s]->buffered(buffered);
+  }
+
+  printf("%d frames%s\n\n", frames, buffered ? ", buffered fixture" : "");
+  printf("%-18s %6s %12s %12s %12s %10s %12s\n", "bench", "pixels", "modulate ns", "render ns", "ns/frame", "ns/pixel", "allocs/frame");
+
+  for (const benchCase& c : benchCases)
+  {
+    if (!strstr(c.name, filter)) continue;
+    for (int s=0; s<(int)(sizeof benchSizes / sizeof benchSizes[0]); s++)
+    {
+      benchResult r = run(c, fixtures[s], frames);
+      uint64_t frame = (r.modulate + r.render) / frames;
+      printf("%-18s %6d %12llu %12llu %12llu %10.2f %12.2f\n", c.name, benchSizes[s],
+        (unsigned long long)(r.modulate / frames), (unsigned long long)(r.render / frames),
+        (unsigned long long)frame, frame / (float)benchSizes[s], r.allocs / (float)frames);
+    }
+  }
+
+  printf("\n%-18s %6s %12s %10s %12s\n", "bench", "pixels", "ns/frame", "ns/pixel", "allocs/frame");
+  for (const writeCase& c : writeCases)
+  {
+    if (!strstr(c.name, filter)) continue;
+    for (int s=0; s<(int)(sizeof benchSizes / sizeof benchSizes[0]); s++)
+    {
+      K32_fixture* fix = new K32_fixture(benchSizes[s]);
+      fix->buffered(c.buffered);
+      c.run(fix, BENCH_WARMUP);
+      countAllocs = true;
+      uint64_t frame = c.run(fix, frames) / frames;
+      countAllocs = false;
+      printf("%-18s %6d %12llu %10.2f %12.2f\n", c.name, benchSizes[s],
+        (unsigned long long)frame, frame / (float)benchSizes[s], allocs / (float)frames);
+      allocs = 0;
+    }
+  }
+
+  printf("\n%-18s %6s %12s %10s %12s %10s %8s\n", "bench", "pixels", "ns/frame", "ns/pixel", "crgbw ns", "ns/pixel", "speedup");
+  for (const spanCase& c : spanCases)
+  {
+    if (!strstr(c.name, filter)) continue;
+    for (int s=0; s<(int)(sizeof benchSizes / sizeof benchSizes[0]); s++)
+    {
+      int n = benchSizes[s];
+      spanRun(c.packed, n, BENCH_WARMUP);
+      uint64_t packed = spanRun(c.packed, n, frames) / frames;
+      uint64_t reference = spanRun(c.reference, n, frames) / frames;
+      printf("%-18s %6d %12llu %10.2f %12llu %10.2f %7.1fx\n", c.name, n,
+        (unsigned long long)packed, packed / (float)n, (unsigned long long)reference, reference / (float)n, 
+        reference / (float)max((uint64_t)1, packed));
+    }
+  }
+
+  printf("\n%-18s %6s %12s %10s %12s %10s %8s\n", "bench", "pixels", "ns/frame", "ns/pixel", "float ns", "ns/pixel", "speedup");
+  for (const waveCase& c : waveCases)
+  {
+    if (!strstr(c.name, filter)) continue;
+    for (int s=0; s<(int)(sizeof benchSizes / sizeof benchSizes[0]); s++)
+    {
+      int n = benchSizes[s];
+      waveRun(c.fixed, n, BENCH_WARMUP);
+      uint64_t fixed = waveRun(c.fixed, n, frames) / frames;
+      uint64_t reference = waveRun(c.reference, n, frames) / frames;
+      printf("%-18s %6d %12llu %10.2f %12llu %10.2f %7.1fx\n", c.name, n,
+        (unsigned long long)fixed, fixed / (float)n, (unsigned long long)reference, reference / (float)n, 
+        reference / (float)max((uint64_t)1, fixed));
+    }
+  }
+
+  fflush(stdout);
+  _exit(0);       // fixture tasks never return
+}
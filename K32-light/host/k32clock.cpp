@@ -0,0 +1,189 @@
+/*
+  k32clock.cpp
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Show clock sync (K32_clock) between simulated nodes over loopback UDP:
+    ./k32clock [-n nodes] [-t seconds] [-x speed] [-i interval] [-j jitter]
+
+    node 0 is master: /clock beacons every interval ms (as K32_osc with clockInterval)
+    every node has its own local clock: random offset and crystal drift (+/- 50 ppm)
+    beacons are delivered with random delay (0 -> jitter ms)
+    time runs speed times faster than real time, drift estimate needs minutes
+*/
+
+#include <Arduino.h>
+#include <utils/K32_clock.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define SIM_PORT        41000
+#define SIM_MAXNODES    32
+
+typedef std::chrono::steady_clock simClock;
+static const simClock::time_point simStart = simClock::now();
+static int speed = 20;
+
+// simulated time (ms, double: sub ms drift)
+static double simMillis() {
+  return std::chrono::duration<double, std::milli>(simClock::now() - simStart).count() * speed;
+}
+
+static void simDelay(double ms) {
+  std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(ms * 1000 / speed)));
+}
+
+struct simNode {
+  K32_clock clock;
+  double offset;      // local clock at sim time 0 (ms)
+  double ppm;         // local crystal error
+  int sock;
+
+  uint32_t local() { return (uint32_t)(int64_t)(this->offset + simMillis() * (1.0 + this->ppm / 1000000)); }
+};
+
+static simNode nodes[SIM_MAXNODES];
+static int nodeCount = 4;
+static std::atomic<bool> running {true};
+
+
+//
+// OSC /clock ,i [int32]: what K32_osc sends and receives
+//
+
+static int oscClock(uint8_t* buf, uint32_t show)
+{
+  memcpy(buf, "/clock\0\0,i\0\0", 12);
+  uint32_t be = htonl(show);
+  memcpy(buf+12, &be, 4);
+  return 16;
+}
+
+static bool oscClockParse(const uint8_t* buf, int size, uint32_t& show)
+{
+  if (size != 16 || memcmp(buf, "/clock\0\0,i\0\0", 12) != 0) return false;
+  uint32_t be;
+  memcpy(&be, buf+12, 4);
+  show = ntohl(be);
+  return true;
+}
+
+
+//
+// NODES
+//
+
+static int openSocket(int port)
+{
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(sock, (sockaddr*)&addr, sizeof addr) < 0) { perror("bind"); exit(1); }
+
+  timeval timeout = {0, 100000};
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+  return sock;
+}
+
+// master: beacon stamped right before send (one datagram per node: loopback has no broadcast)
+static void master(int interval)
+{
+  uint8_t buf[16];
+  sockaddr_in dest = {};
+  dest.sin_family = AF_INET;
+  dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  while (running) {
+    for (int n=1; n<nodeCount; n++) {
+      int size = oscClock(buf, nodes[0].clock.at(nodes[0].local()));
+      dest.sin_port = htons(SIM_PORT + n);
+      sendto(nodes[0].sock, buf, size, 0, (sockaddr*)&dest, sizeof dest);
+    }
+    simDelay(interval);
+  }
+}
+
+// slave: receive, network delay, timestamp with local clock, feed K32_clock (as K32_osc server)
+static void slave(int n, int jitter)
+{
+  std::mt19937 rng(n);
+  std::uniform_real_distribution<double> delay(0, jitter);
+  uint8_t buf[64];
+  uint32_t show;
+
+  while (running) {
+    int size = recv(nodes[n].sock, buf, sizeof buf, 0);
+    if (size <= 0) continue;
+    simDelay(delay(rng));
+    uint32_t received = nodes[n].local();
+    if (oscClockParse(buf, size, show)) nodes[n].clock.beacon(show, received);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int seconds = 600;
+  int interval = 250;
+  int jitter = 5;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:t:x:i:j:")) != -1)
+    switch (opt) {
+      case 'n': nodeCount = constrain(atoi(optarg), 2, SIM_MAXNODES); break;
+      case 't': seconds = max(1, atoi(optarg)); break;
+      case 'x': speed = max(1, atoi(optarg)); break;
+      case 'i': interval = max(1, atoi(optarg)); break;
+      case 'j': jitter = max(0, atoi(optarg)); break;
+      default:
+        fprintf(stderr, "usage: %s [-n nodes] [-t seconds] [-x speed] [-i interval] [-j jitter]\n", argv[0]);
+        return 1;
+    }
+
+  Serial.begin(115200);
+
+  std::mt19937 rng(42);
+  for (int n=0; n<nodeCount; n++) {
+    nodes[n].offset = std::uniform_real_distribution<double>(0, 1000000)(rng);
+    nodes[n].ppm = std::uniform_real_distribution<double>(-50, 50)(rng);
+    nodes[n].sock = openSocket(SIM_PORT + n);
+  }
+
+  printf("%d nodes, beacon %d ms, jitter %d ms, %d s at x%d\n\n", nodeCount, interval, jitter, seconds, speed);
+  printf("%8s", "time s");
+  for (int n=1; n<nodeCount; n++) printf("   node%-2d err ms / drift ppm (true)", n);
+  printf("\n");
+
+  std::vector<std::thread> threads;
+  threads.emplace_back(master, interval);
+  for (int n=1; n<nodeCount; n++) threads.emplace_back(slave, n, jitter);
+
+  // REPORT: show time error of each node vs master, every 10 s
+  int worst = 0;
+  for (int s=10; s<=seconds; s+=10)
+  {
+    simDelay(10000);
+    uint32_t show = nodes[0].clock.at(nodes[0].local());
+    printf("%8d", s);
+    for (int n=1; n<nodeCount; n++) {
+      int err = (int32_t)(nodes[n].clock.at(nodes[n].local()) - show);
+      double truePpm = ((1.0 + nodes[0].ppm / 1000000) / (1.0 + nodes[n].ppm / 1000000) - 1.0) * 1000000;
+      printf("   %12d / %6d (%6.1f)     ", err, nodes[n].clock.drift(), truePpm);
+      if (s > seconds/2) worst = max(worst, abs(err));
+    }
+    printf("\n");
+  }
+  printf("\nworst error over last half: %d ms\n", worst);
+
+  running = false;
+  for (auto& t : threads) t.join();
+  return 0;
+}
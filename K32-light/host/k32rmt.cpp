@@ -0,0 +1,181 @@
+/*
+  k32rmt.cpp
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  RMT output off-target (_librmt/rmt_encoder.h, same code as the RMT interrupt):
+    ./k32rmt [-n frames] [-t type]
+
+  ENCODER: cost of encoding a whole frame into RMT pulses, bit shifting vs pre-encoded bytes
+           (host cpu: compare the two, not the absolute values)
+  REFILL:  transmission of a frame simulated pulse by pulse on a channel memory of 1 -> 8 blocks:
+           interrupts per frame (refills + tx end), and refill deadline: time left to the interrupt
+           to refill a half before the RMT reads it (WiFi interrupt latency must stay below)
+           every transmitted pulse is checked against the strand bytes
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include "_librmt/esp32_digital_led_lib.h"
+#include "_librmt/rmt_encoder.h"
+
+#define RMT_FRAMES      2000
+#define RMT_DIVIDER     4       // as esp32_digital_led_lib.cpp
+#define RMT_TICK_NS     12.5
+
+static const int rmtSizes[] = {60, 144, 300, 512};
+static const int rmtBlocks[] = {1, 2, 4, 8};
+
+typedef std::chrono::steady_clock benchClock;
+
+static uint64_t nanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(benchClock::now().time_since_epoch()).count();
+}
+
+// strand transmission buffer, with random bytes and pulses of led type (as digitalLeds_addStrand)
+static void setupTx(rmtTx_t* tx, const ledParams_t& led, int pixels, int blocks)
+{
+  tx->buf_len = pixels * led.bytesPerPixel;
+  tx->buf_data = static_cast<uint8_t*>(malloc(tx->buf_len));
+  for (int k=0; k<tx->buf_len; k++) tx->buf_data[k] = random(256);
+  tx->buf_pos = 0;
+  tx->buf_half = 0;
+  tx->buf_isDirty = 0;
+  tx->maxPulses = blocks * RMT_BLOCK_PULSES / 2;
+  tx->resetDuration = led.TRS / (RMT_TICK_NS * RMT_DIVIDER);
+  tx->byteMap = nullptr;
+
+  for (int b=0; b<2; b++) {
+    tx->pulsePairMap[b].level0 = 1;
+    tx->pulsePairMap[b].level1 = 0;
+    tx->pulsePairMap[b].duration0 = (b ? led.T1H : led.T0H) / (RMT_TICK_NS * RMT_DIVIDER);
+    tx->pulsePairMap[b].duration1 = (b ? led.T1L : led.T0L) / (RMT_TICK_NS * RMT_DIVIDER);
+  }
+}
+
+// start of transmission: both halves prefilled (as loadPixels)
+static void load(rmtTx_t* tx, volatile rmtPulsePair* mem)
+{
+  tx->buf_pos = 0;
+  tx->buf_half = 0;
+  rmtFillHalf(tx, mem);
+  if (tx->buf_pos < tx->buf_len) rmtFillHalf(tx, mem);
+}
+
+
+//
+// ENCODER: every half of a frame encoded back to back
+//
+
+static uint64_t encode(rmtTx_t* tx, volatile rmtPulsePair* mem, int frames)
+{
+  uint64_t t0 = nanos();
+  for (int f=0; f<frames; f++) {
+    load(tx, mem);
+    while (tx->buf_pos < tx->buf_len || tx->buf_isDirty) rmtFillHalf(tx, mem);
+  }
+  return nanos() - t0;
+}
+
+
+//
+// REFILL: RMT reads channel memory with wrap around, threshold interrupt every maxPulses pulses,
+// a zero pulse ends the transmission
+//
+
+struct refillResult {
+  int interrupts;
+  int pulses;
+  bool valid;
+};
+
+static refillResult transmit(rmtTx_t* tx, volatile rmtPulsePair* mem)
+{
+  refillResult r = {0, 0, true};
+  int size = tx->maxPulses * 2;
+
+  load(tx, mem);
+  for (int idx = 0; ; idx++)
+  {
+    rmtPulsePair pulse;
+    pulse.val = mem[idx % size].val;
+    if (pulse.duration0 == 0) break;
+
+    // expected: bit of strand byte, MSB first, last one stretched by reset
+    int byte = r.pulses / 8;
+    int bit = (byte < tx->buf_len) ? (tx->buf_data[byte] >> (7 - r.pulses % 8)) & 1 : 0;
+    rmtPulsePair expected = tx->pulsePairMap[bit];
+    if (r.pulses == tx->buf_len * 8 - 1) expected.duration1 = tx->resetDuration;
+    if (byte >= tx->buf_len || pulse.val != expected.val) r.valid = false;
+    r.pulses += 1;
+
+    if ((idx + 1) % tx->maxPulses == 0) {
+      rmtFillHalf(tx, mem);             // tx_thr_event
+      r.interrupts += 1;
+    }
+  }
+  r.interrupts += 1;                    // tx_end
+  r.valid = r.valid && (r.pulses == tx->buf_len * 8);
+  return r;
+}
+
+int main(int argc, char** argv)
+{
+  int frames = RMT_FRAMES;
+  int type = LED_SK6812W_V1;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:t:")) != -1)
+    switch (opt) {
+      case 'n': frames = max(1, atoi(optarg)); break;
+      case 't': type = constrain(atoi(optarg), 0, LED_SK6812W_V1); break;
+      default:
+        fprintf(stderr, "usage: %s [-n frames] [-t type]\n", argv[0]);
+        return 1;
+    }
+
+  const ledParams_t& led = ledParamsAll[type];
+  float bitUs = (led.T0H + led.T0L) / 1000.0f;
+  static rmtPulsePair byteMap[256 * 8];
+  volatile rmtPulsePair* mem = static_cast<rmtPulsePair*>(calloc(8 * RMT_BLOCK_PULSES, sizeof(rmtPulsePair)));
+  bool valid = true;
+
+  printf("led type %d: %d bytes per pixel, %.2f us per bit\n", type, led.bytesPerPixel, bitUs);
+
+  // ENCODER
+  printf("\n%-12s %6s %12s %12s %10s\n", "encoder", "pixels", "bits ns", "bytemap ns", "speedup");
+  for (int pixels : rmtSizes)
+  {
+    rmtTx_t tx;
+    setupTx(&tx, led, pixels, 1);
+    rmtBuildByteMap(byteMap, tx.pulsePairMap);
+
+    encode(&tx, mem, frames / 10);
+    uint64_t bits = encode(&tx, mem, frames) / frames;
+    tx.byteMap = byteMap;
+    uint64_t bytes = encode(&tx, mem, frames) / frames;
+
+    printf("%-12s %6d %12llu %12llu %9.1fx\n", "frame", pixels,
+      (unsigned long long)bits, (unsigned long long)bytes, bits / (float)max((uint64_t)1, bytes));
+    free(tx.buf_data);
+  }
+
+  // REFILL
+  printf("\n%-12s %6s %6s %12s %14s %12s\n", "refill", "pixels", "blocks", "irq/frame", "deadline us", "frame us");
+  for (int pixels : rmtSizes)
+    for (int blocks : rmtBlocks)
+    {
+      rmtTx_t tx;
+      setupTx(&tx, led, pixels, blocks);
+      memset((void*)mem, 0, 8 * RMT_BLOCK_PULSES * sizeof(rmtPulsePair));
+
+      refillResult r = transmit(&tx, mem);
+      valid = valid && r.valid;
+      printf("%-12s %6d %6d %12d %14.1f %12.0f%s\n", "strand", pixels, blocks, r.interrupts,
+        tx.maxPulses * bitUs, r.pulses * bitUs, r.valid ? "" : "   INVALID PULSES");
+      free(tx.buf_data);
+    }
+
+  if (!valid) printf("\nERROR: transmitted pulses differ from strand bytes\n");
+  return valid ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+/*
+  k32sim.cpp
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Run the light pipeline on Linux against virtual leds:
+    ./k32sim [-t seconds] [-f fps] [-s strips] [-n pixels] [-r rate] [-c] [-p] [-y] [-w] [-o frames.bin]
+
+    -c  clone strip 0 on every other strip (routes, see K32_light::cloneFixturesFrom)
+    -r  output rate of the last strip (as a slow DMX fixture, see K32_fixture::rate)
+    -p  pipeline (buffered fixtures, output task)
+    -y  sync strips output (pushed together by the render / output task)
+    -w  simulate WS2812 wire time on push
+    -o  record every pushed frame (see virtual_leds.h for the format)
+*/
+
+#include <Arduino.h>
+#include <K32.h>
+#include "K32_light.h"
+#include "fixtures/K32_ledstrip.h"
+#include "virtual_leds.h"
+
+static void printStage(const char* name, stageTiming& t, uint32_t frames)
+{
+  uint32_t avg = frames ? t.total / frames : 0;
+  printf("  %-10s avg %6u us   max %6u us\n", name, avg, t.max);
+}
+
+int main(int argc, char** argv)
+{
+  int seconds = 5;
+  int fps = LIGHT_SHOW_FPS;
+  int strips = 2;
+  int pixels = 300;
+  int rate = 0;
+  bool pipeline = false;
+  bool sync = false;
+  bool clone = false;
+  FILE* record = nullptr;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "t:f:s:n:r:cpywo:")) != -1)
+    switch (opt) {
+      case 't': seconds = atoi(optarg); break;
+      case 'f': fps = atoi(optarg); break;
+      case 's': strips = constrain(atoi(optarg), 1, LIGHT_MAXFIXTURES); break;
+      case 'n': pixels = constrain(atoi(optarg), 1, FIXTURE_MAXPIXEL); break;
+      case 'r': rate = atoi(optarg); break;
+      case 'c': clone = true; break;
+      case 'p': pipeline = true; break;
+      case 'y': sync = true; break;
+      case 'w': virtualLeds_wire(true); break;
+      case 'o':
+        record = fopen(optarg, "wb");
+        if (!record) { perror(optarg); return 1; }
+        virtualLeds_record(record);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-t seconds] [-f fps] [-s strips] [-n pixels] [-r rate] [-c] [-p] [-y] [-w] [-o frames.bin]\n", argv[0]);
+        return 1;
+    }
+
+  K32* k32 = new K32();
+  K32_light* light = new K32_light(k32);
+
+  // FIXTURES
+  for (int s=0; s<strips; s++) {
+    K32_fixture* strip = light->addFixture( new K32_ledstrip(s, 21+s, LED_SK6812W_V1, pixels) );
+    if (pipeline) strip->buffered(true);
+    if (s == strips-1) strip->rate(rate);
+  }
+  light->fps(fps);
+  light->pipeline(pipeline);
+  light->sync(sync);
+  if (clone) light->cloneFixturesFrom(light->fixture(0));
+
+  // ANIMS: one color per strip, dimmed by a sinus wave traveling along the strip
+  for (int s=0; s<(clone ? 1 : strips); s++) {
+    K32_anim* color = light->anim( light->fixture(s), "color"+String(s), new K32_anim_color() );
+    color->push(255, 40*s, 0, 20);
+    color->mod( "wave", new K32_mod_sinus )->period(1000 + 500*s)->wavelength(pixels/2)->play();
+    color->play();
+  }
+
+  // RUN: stats and pushed frames counted after warm up (strips black at init, first frames)
+  delay(500);
+  light->resetStats();
+  virtualLeds_resetFrames();
+  delay(seconds * 1000);
+
+  // REPORT
+  lightStats stats = light->stats();
+  printf("\n%d strips x %d pixels, %d fps%s, %d s\n", strips, pixels, fps, pipeline ? " (pipeline)" : "", seconds);
+  if (sync) printf("  sync output\n");
+  if (clone) printf("  strip 0 cloned\n");
+  printf("  frames     %u (%.1f fps)   dropped %u\n", stats.frames, stats.frames / (float)seconds, stats.dropped);
+  printStage("modulate", stats.modulate, stats.frames);
+  printStage("draw", stats.draw, stats.frames);
+  printStage("blend", stats.blend, stats.frames);
+  printStage("composite", stats.composite, stats.frames);
+  printStage("output", stats.output, stats.frames);
+  printStage("flush", stats.flush, stats.frames);
+  printStage("frame", stats.frame, stats.frames);
+  for (int k=0; k<virtualLeds_strands(); k++)
+    printf("  strand %d   %u frames pushed, rate %d fps\n", k, virtualLeds_frames(virtualLeds_strand(k)), light->rate(k));
+
+  printf("  status     %s\n", light->status().c_str());
+
+  virtualLeds_record(nullptr);
+  if (record) fclose(record);
+  fflush(stdout);
+  _exit(0);       // tasks never return
+}
@@ -0,0 +1,139 @@
+/*
+  Arduino.h (host shim)
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Just enough of the ESP32 Arduino core and FreeRTOS to build the light pipeline on Linux:
+  tasks are threads, semaphores / queues / notifications keep their FreeRTOS semantics,
+  1 tick = 1 ms, task priorities and cores are ignored.
+*/
+#ifndef K32_HOST_ARDUINO_h
+#define K32_HOST_ARDUINO_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+
+using std::min;
+using std::max;
+using std::abs;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define K32_HOST        1
+
+#define IRAM_ATTR
+#define PROGMEM
+#define F(s)            (s)
+#define PI              3.1415926535897932384626433832795
+#define DEC             10
+#define HEX             16
+#define BIN             2
+#define LOW             0
+#define HIGH            1
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define SERIAL_8N1      0
+
+#define constrain(x, lo, hi)   ((x)<(lo)?(lo):((x)>(hi)?(hi):(x)))
+
+//
+// FREERTOS
+//
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE              1
+#define pdFALSE             0
+#define pdPASS              1
+#define pdFAIL              0
+#define portMAX_DELAY       0xFFFFFFFFu
+#define portTICK_PERIOD_MS  1
+#define configTICK_RATE_HZ  1000
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define tskNO_AFFINITY      0x7FFFFFFF
+
+typedef struct QueueDefinition* QueueHandle_t;
+typedef QueueHandle_t SemaphoreHandle_t;
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// tasks
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg, UBaseType_t prio, TaskHandle_t* handle, BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg, UBaseType_t prio, TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t ticks);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) { return 0; }   // threads stacks are not watched
+
+// notifications
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+
+// queues (semaphores are queues of empty items, like FreeRTOS)
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+void vQueueDelete(QueueHandle_t queue);
+#define xQueueSendToBack    xQueueSend
+
+// semaphores
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem);
+#define vSemaphoreDelete    vQueueDelete
+
+//
+// ARDUINO
+//
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void yield() {}
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+inline long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// GPIO / PWM: no hardware, writes are dropped
+inline void pinMode(uint8_t pin, uint8_t mode) {}
+inline void digitalWrite(uint8_t pin, uint8_t val) {}
+inline int digitalRead(uint8_t pin) { return LOW; }
+inline uint16_t analogRead(uint8_t pin) { return 0; }
+inline double ledcSetup(uint8_t chan, double freq, uint8_t resolution) { return freq; }
+inline void ledcAttachPin(uint8_t pin, uint8_t chan) {}
+inline void ledcWrite(uint8_t chan, uint32_t duty) {}
+
+#include "WString.h"
+#include "HardwareSerial.h"
+
+class EspClass {
+  public:
+    void restart() { fflush(stdout); _exit(0); }
+    uint32_t getFreeHeap() { return 0; }
+};
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,58 @@
+/*
+  HardwareSerial.h (host shim)
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+*/
+#ifndef K32_HOST_SERIAL_h
+#define K32_HOST_SERIAL_h
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "WString.h"
+
+// Serial on stdout (K32_HOST_QUIET=1 in environment mutes it)
+class HardwareSerial {
+  public:
+    void begin(unsigned long baud, uint32_t config = 0) { _quiet = getenv("K32_HOST_QUIET") != nullptr; }
+    void end() {}
+    void setTimeout(unsigned long ms) {}
+    void flush() { fflush(stdout); }
+    int available() { return 0; }
+    int read() { return -1; }
+    operator bool() { return true; }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)))
+    {
+      if (_quiet) return 0;
+      va_list args;
+      va_start(args, format);
+      int n = vprintf(format, args);
+      va_end(args);
+      return (n < 0) ? 0 : n;
+    }
+
+    size_t print(const String& s) { return this->write(s.c_str()); }
+    size_t print(const char* s) { return this->write(s); }
+    size_t print(char c) { return this->printf("%c", c); }
+    size_t print(int v, int base = 10) { return this->print(String(v, base)); }
+    size_t print(unsigned int v, int base = 10) { return this->print(String(v, base)); }
+    size_t print(long v, int base = 10) { return this->print(String(v, base)); }
+    size_t print(unsigned long v, int base = 10) { return this->print(String(v, base)); }
+    size_t print(double v, int decimals = 2) { return this->print(String(v, decimals)); }
+
+    size_t println() { return this->write("\n"); }
+    template<typename T> size_t println(T v) { return this->print(v) + this->println(); }
+    template<typename T> size_t println(T v, int format) { return this->print(v, format) + this->println(); }
+
+  private:
+    bool _quiet = false;
+
+    size_t write(const char* s) {
+      if (_quiet) return 0;
+      return fputs(s, stdout) < 0 ? 0 : strlen(s);
+    }
+};
+
+extern HardwareSerial Serial;
+
+#endif
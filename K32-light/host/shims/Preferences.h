@@ -0,0 +1,31 @@
+/*
+  Preferences.h (host shim)
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+*/
+#ifndef K32_HOST_PREFERENCES_h
+#define K32_HOST_PREFERENCES_h
+
+#include <map>
+#include <string>
+#include "Arduino.h"
+
+// NVS in memory: values do not survive the process
+class Preferences {
+  public:
+    bool begin(const char* name, bool readOnly = false) { return true; }
+    void end() {}
+    bool clear() { _values.clear(); return true; }
+    bool remove(const char* key) { return _values.erase(key) > 0; }
+    bool isKey(const char* key) { return _values.count(key) > 0; }
+
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return isKey(key) ? _values[key] : defaultValue; }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return isKey(key) ? (int32_t)_values[key] : defaultValue; }
+    size_t putUInt(const char* key, uint32_t value) { _values[key] = value; return 4; }
+    size_t putInt(const char* key, int32_t value) { _values[key] = value; return 4; }
+
+  private:
+    std::map<std::string, uint32_t> _values;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+  Timer.h (host shim)
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Event timer (same API as the Arduino "Timer" library used on target)
+*/
+#ifndef K32_HOST_TIMER_h
+#define K32_HOST_TIMER_h
+
+#include "Arduino.h"
+
+#define MAX_NUMBER_OF_EVENTS  10
+#define TIMER_NOT_AN_EVENT    -2
+#define NO_TIMER_AVAILABLE    -1
+
+class Timer {
+  public:
+    int8_t every(unsigned long period, void (*callback)(void*), void* context) { return this->every(period, callback, -1, context); }
+    int8_t every(unsigned long period, void (*callback)(void*), int repeatCount, void* context) 
+    {
+      for (int8_t i=0; i<MAX_NUMBER_OF_EVENTS; i++)
+        if (!_events[i].callback) {
+          _events[i] = {period, millis(), repeatCount, callback, context};
+          return i;
+        }
+      return NO_TIMER_AVAILABLE;
+    }
+    int8_t after(unsigned long duration, void (*callback)(void*), void* context) { return this->every(duration, callback, 1, context); }
+
+    void stop(int8_t id) {
+      if (id >= 0 && id < MAX_NUMBER_OF_EVENTS) _events[id].callback = nullptr;
+    }
+
+    void update() 
+    {
+      unsigned long now = millis();
+      for (int i=0; i<MAX_NUMBER_OF_EVENTS; i++) {
+        event& e = _events[i];
+        if (!e.callback || now - e.last < e.period) continue;
+        e.last = now;
+        void (*callback)(void*) = e.callback;
+        if (e.repeat > 0 && --e.repeat == 0) e.callback = nullptr;
+        callback(e.context);
+      }
+    }
+
+  private:
+    struct event {
+      unsigned long period;
+      unsigned long last;
+      int repeat;
+      void (*callback)(void*);
+      void* context;
+    };
+    event _events[MAX_NUMBER_OF_EVENTS] = {};
+};
+
+#endif
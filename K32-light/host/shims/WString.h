@@ -0,0 +1,127 @@
+/*
+  WString.h (host shim)
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+*/
+#ifndef K32_HOST_WSTRING_h
+#define K32_HOST_WSTRING_h
+
+#include <string>
+#include <type_traits>
+#include <stdlib.h>
+#include <stdio.h>
+#include <strings.h>
+
+// Arduino String on top of std::string
+class String {
+  public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(int v, unsigned char base = 10)            { this->number(v, base); }
+    String(unsigned int v, unsigned char base = 10)   { this->number(v, base); }
+    String(long v, unsigned char base = 10)           { this->number(v, base); }
+    String(unsigned long v, unsigned char base = 10)  { this->number(v, base); }
+    String(double v, unsigned char decimals = 2) {
+      char buf[64];
+      snprintf(buf, sizeof buf, "%.*f", decimals, v);
+      _s = buf;
+    }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    bool isEmpty() const { return _s.empty(); }
+    void reserve(unsigned int size) { _s.reserve(size); }
+
+    char charAt(unsigned int i) const { return (i < _s.length()) ? _s[i] : 0; }
+    char operator[](unsigned int i) const { return this->charAt(i); }
+    char& operator[](unsigned int i) { return _s[i]; }
+
+    bool equals(const String& s) const { return _s == s._s; }
+    bool equalsIgnoreCase(const String& s) const { return strcasecmp(_s.c_str(), s.c_str()) == 0; }
+    int compareTo(const String& s) const { return _s.compare(s._s); }
+    bool startsWith(const String& s) const { return _s.compare(0, s._s.length(), s._s) == 0; }
+    bool endsWith(const String& s) const {
+      return _s.length() >= s._s.length() && _s.compare(_s.length() - s._s.length(), s._s.length(), s._s) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return found(_s.find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return found(_s.find(s._s, from)); }
+    int lastIndexOf(char c) const { return found(_s.rfind(c)); }
+    int lastIndexOf(const String& s) const { return found(_s.rfind(s._s)); }
+
+    String substring(unsigned int from) const { return (from < _s.length()) ? String(_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+      if (from > to) std::swap(from, to);
+      if (from >= _s.length()) return String();
+      return String(_s.substr(from, to - from));
+    }
+
+    long toInt() const { return atol(_s.c_str()); }
+    float toFloat() const { return atof(_s.c_str()); }
+    double toDouble() const { return atof(_s.c_str()); }
+
+    void toCharArray(char* buf, unsigned int size, unsigned int index = 0) const {
+      if (!size || !buf) return;
+      strncpy(buf, (index < _s.length()) ? _s.c_str() + index : "", size - 1);
+      buf[size - 1] = 0;
+    }
+    void getBytes(unsigned char* buf, unsigned int size, unsigned int index = 0) const {
+      this->toCharArray((char*)buf, size, index);
+    }
+
+    void trim() {
+      size_t a = _s.find_first_not_of(" \t\r\n");
+      size_t b = _s.find_last_not_of(" \t\r\n");
+      _s = (a == std::string::npos) ? "" : _s.substr(a, b - a + 1);
+    }
+    void toLowerCase() { for (auto& c : _s) c = tolower(c); }
+    void toUpperCase() { for (auto& c : _s) c = toupper(c); }
+    void replace(const String& from, const String& to) {
+      if (from._s.empty()) return;
+      for (size_t p = _s.find(from._s); p != std::string::npos; p = _s.find(from._s, p + to._s.length()))
+        _s.replace(p, from._s.length(), to._s);
+    }
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1) {
+      if (index < _s.length()) _s.erase(index, count);
+    }
+    void setCharAt(unsigned int i, char c) { if (i < _s.length()) _s[i] = c; }
+
+    bool concat(const String& s) { _s += s._s; return true; }
+    String& operator+=(const String& s) { _s += s._s; return *this; }
+    String& operator+=(const char* s) { _s += s; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    String& operator+=(int v) { return *this += String(v); }
+    String& operator+=(unsigned int v) { return *this += String(v); }
+    String& operator+=(long v) { return *this += String(v); }
+    String& operator+=(unsigned long v) { return *this += String(v); }
+
+    friend String operator+(const String& a, const String& b) { return String(a._s + b._s); }
+    friend String operator+(const String& a, const char* b) { return String(a._s + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b._s); }
+
+    bool operator==(const String& s) const { return _s == s._s; }
+    bool operator==(const char* s) const { return _s == s; }
+    bool operator!=(const String& s) const { return _s != s._s; }
+    bool operator!=(const char* s) const { return _s != s; }
+    bool operator<(const String& s) const { return _s < s._s; }
+
+  private:
+    std::string _s;
+
+    static int found(size_t p) { return (p == std::string::npos) ? -1 : (int)p; }
+
+    template<typename T> void number(T v, unsigned char base)
+    {
+      if (base == 10) { _s = std::to_string(v); return; }
+      char buf[72];
+      int i = sizeof buf - 1;
+      buf[i] = 0;
+      unsigned long long u = (typename std::make_unsigned<T>::type)v;     // negative: two's complement of T
+      do { buf[--i] = "0123456789ABCDEF"[u % base]; u /= base; } while (u && i > 0);
+      _s = buf + i;
+    }
+};
+
+#endif
@@ -0,0 +1,20 @@
+/*
+  esp_task_wdt.h (host shim)
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+*/
+#ifndef K32_HOST_ESP_TASK_WDT_h
+#define K32_HOST_ESP_TASK_WDT_h
+
+#include "Arduino.h"
+
+typedef int esp_err_t;
+#define ESP_OK  0
+
+// no watchdog on host
+inline esp_err_t esp_task_wdt_init(uint32_t timeout, bool panic) { return ESP_OK; }
+inline esp_err_t esp_task_wdt_add(TaskHandle_t task) { return ESP_OK; }
+inline esp_err_t esp_task_wdt_delete(TaskHandle_t task) { return ESP_OK; }
+inline esp_err_t esp_task_wdt_reset() { return ESP_OK; }
+
+#endif
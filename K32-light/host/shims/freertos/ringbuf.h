@@ -0,0 +1,13 @@
+/*
+  freertos/ringbuf.h (host shim)
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Included by K32_intercom.h, nothing used from it
+*/
+#ifndef K32_HOST_RINGBUF_h
+#define K32_HOST_RINGBUF_h
+
+#include "Arduino.h"
+
+#endif
@@ -0,0 +1,271 @@
+/*
+  host_rtos.cpp (host shim)
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  FreeRTOS / Arduino runtime on std::thread
+*/
+
+#include "Arduino.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+typedef std::chrono::steady_clock hostClock;
+static const hostClock::time_point hostStart = hostClock::now();
+
+// wait on cv until pred or ticks elapsed (portMAX_DELAY: forever)
+template<typename P>
+static bool waitTicks(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, TickType_t ticks, P pred)
+{
+  if (ticks == portMAX_DELAY) { cv.wait(lock, pred); return true; }
+  return cv.wait_for(lock, std::chrono::milliseconds(ticks), pred);
+}
+
+
+//
+// TIME
+//
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(hostClock::now() - hostStart).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(hostClock::now() - hostStart).count();
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+static std::mt19937& randomEngine() {
+  static thread_local std::mt19937 engine(1);
+  return engine;
+}
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  return randomEngine()() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed) {
+  randomEngine().seed(seed);
+}
+
+
+//
+// TASKS
+//
+
+struct tskTaskControlBlock {
+  std::string name;
+  TaskFunction_t fn = nullptr;
+  void* arg = nullptr;
+
+  std::mutex lock;
+  std::condition_variable cv;
+  uint32_t notified = 0;
+};
+
+static thread_local TaskHandle_t currentTask = nullptr;
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+  if (!currentTask) {                       // main thread, or thread not created by xTaskCreate
+    currentTask = new tskTaskControlBlock();
+    currentTask->name = "main";
+  }
+  return currentTask;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg, UBaseType_t prio, TaskHandle_t* handle, BaseType_t core)
+{
+  TaskHandle_t task = new tskTaskControlBlock();
+  task->name = name;
+  task->fn = fn;
+  task->arg = arg;
+  if (handle) *handle = task;
+
+  std::thread([task]() {
+    currentTask = task;
+    pthread_setname_np(pthread_self(), task->name.substr(0, 15).c_str());
+    task->fn(task->arg);
+  }).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg, UBaseType_t prio, TaskHandle_t* handle) {
+  return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, handle, tskNO_AFFINITY);
+}
+
+// only self delete is supported: threads can't be killed
+void vTaskDelete(TaskHandle_t task) {
+  if (task == nullptr || task == currentTask) pthread_exit(nullptr);
+}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks);
+}
+
+TickType_t xTaskGetTickCount() {
+  return millis();
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t ticks)
+{
+  *previousWake += ticks;
+  int32_t wait = (int32_t)(*previousWake - xTaskGetTickCount());
+  if (wait > 0) delay(wait);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+  if (!task) return pdFAIL;
+  std::lock_guard<std::mutex> lock(task->lock);
+  task->notified += 1;
+  task->cv.notify_all();
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks)
+{
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> lock(task->lock);
+  waitTicks(task->cv, lock, ticks, [task]{ return task->notified > 0; });
+  uint32_t value = task->notified;
+  if (value) task->notified = clearOnExit ? 0 : value - 1;
+  return value;
+}
+
+
+//
+// QUEUES / SEMAPHORES
+//
+
+// storage allocated once at creation, like FreeRTOS (semaphores only count items)
+struct QueueDefinition {
+  std::mutex lock;
+  std::condition_variable cv;
+  std::vector<uint8_t> storage;
+  UBaseType_t length = 1;
+  UBaseType_t itemSize = 0;
+  UBaseType_t head = 0;
+  UBaseType_t count = 0;
+
+  // mutex
+  bool isMutex = false;
+  std::atomic<TaskHandle_t> holder {nullptr};
+  int depth = 0;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+  QueueHandle_t q = new QueueDefinition();
+  q->length = max(1u, length);
+  q->itemSize = itemSize;
+  q->storage.resize(q->length * itemSize);
+  return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks)
+{
+  std::unique_lock<std::mutex> lock(q->lock);
+  if (!waitTicks(q->cv, lock, ticks, [q]{ return q->count < q->length; })) return pdFAIL;
+  if (item && q->itemSize) 
+    memcpy(&q->storage[((q->head + q->count) % q->length) * q->itemSize], item, q->itemSize);
+  q->count += 1;
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks)
+{
+  std::unique_lock<std::mutex> lock(q->lock);
+  if (!waitTicks(q->cv, lock, ticks, [q]{ return q->count > 0; })) return pdFAIL;
+  if (item && q->itemSize) memcpy(item, &q->storage[q->head * q->itemSize], q->itemSize);
+  q->head = (q->head + 1) % q->length;
+  q->count -= 1;
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  std::lock_guard<std::mutex> lock(q->lock);
+  return q->count;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+  delete q;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return xQueueCreate(1, 0);                                  // created empty
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+  SemaphoreHandle_t s = xQueueCreate(maxCount, 0);
+  s->count = min(initialCount, s->length);
+  return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+  SemaphoreHandle_t s = xSemaphoreCreateCounting(1, 1);       // created available
+  s->isMutex = true;
+  return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  return xSemaphoreCreateMutex();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks)
+{
+  if (xQueueReceive(s, nullptr, ticks) != pdPASS) return pdFAIL;
+  if (s->isMutex) s->holder = xTaskGetCurrentTaskHandle();
+  return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+  if (s->isMutex) s->holder = nullptr;
+  return xQueueSend(s, nullptr, 0);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t s, TickType_t ticks)
+{
+  if (s->holder == xTaskGetCurrentTaskHandle()) {
+    s->depth += 1;
+    return pdPASS;
+  }
+  if (xSemaphoreTake(s, ticks) != pdPASS) return pdFAIL;
+  s->depth = 1;
+  return pdPASS;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t s)
+{
+  if (s->holder != xTaskGetCurrentTaskHandle()) return pdFAIL;
+  if (--s->depth > 0) return pdPASS;
+  return xSemaphoreGive(s);
+}
@@ -0,0 +1,39 @@
+/*
+  check.h
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Minimal checks for host tests (see Makefile: make test):
+  a failed CHECK prints file:line and the expression, the test exits 1 if any failed.
+*/
+#ifndef K32_HOST_CHECK_h
+#define K32_HOST_CHECK_h
+
+#include <stdio.h>
+
+static int checkFailed = 0;
+static int checkCount = 0;
+
+#define CHECK(expr)  do {                                                       \
+    checkCount++;                                                               \
+    if (!(expr)) {                                                              \
+      if (checkFailed++ < 20) printf("  FAIL %s:%d  %s\n", __FILE__, __LINE__, #expr); \
+    }                                                                           \
+  } while (0)
+
+#define CHECK_EQ(a, b)  do {                                                    \
+    checkCount++;                                                               \
+    long long _a = (long long)(a), _b = (long long)(b);                         \
+    if (_a != _b) {                                                             \
+      if (checkFailed++ < 20) printf("  FAIL %s:%d  %s == %s  (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+    }                                                                           \
+  } while (0)
+
+// end of test: summary and exit code
+static int checkDone(const char* name) {
+  printf("%-16s %s  (%d checks, %d failed)\n", name, checkFailed ? "FAIL" : "ok", checkCount, checkFailed);
+  fflush(stdout);
+  return checkFailed ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,152 @@
+/*
+  test_modulator.cpp
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Modulator params and oscillator:
+    user getters give back the last value set
+    period set by user: oscillator re-anchors on time() % period, two modulators sharing the same
+    clock (two nodes on show time) stay in phase whenever the change reaches them
+    period swept by the modulation graph: progress stays continuous
+    modulators replaced / removed by users while the render task runs them
+    (use after free shows with make CXXFLAGS="-O1 -g -fsanitize=address")
+*/
+
+#include <Arduino.h>
+#include "K32_light.h"
+#include <atomic>
+#include <thread>
+#include "check.h"
+
+// modulator on a test clock (as show time on every node)
+static int simTime = 0;
+
+template<typename M>
+class clocked : public M {
+  public:
+    int time() { return simTime; }
+};
+
+static int data[ANIM_DATA_SLOTS];
+
+static void frame(K32_modulator* mod) {
+  mod->run(data);
+}
+
+// USERS: read back what was set, before the render task loads it
+static void testGetters()
+{
+  K32_modulator* mod = new clocked<K32_mod_sinus>;
+  mod->period(500)->phase(90)->mini(10)->maxi(200)->wavelength(30);
+  CHECK_EQ(mod->period(), 500);
+  CHECK_EQ(mod->phase(), 90);
+  CHECK_EQ(mod->mini(), 10);
+  CHECK_EQ(mod->maxi(), 200);
+  CHECK_EQ(mod->amplitude(), 190);
+  CHECK_EQ(mod->wavelength(), 30);
+
+  mod->faster();
+  CHECK_EQ(mod->period(), 416);
+  mod->edit()->period(800)->maxi(100)->commit();
+  CHECK_EQ(mod->period(), 800);
+  CHECK_EQ(mod->maxi(), 100);
+  delete mod;
+}
+
+// NODES: same show time, frames at different instants, period change received at different instants
+static void testPhase()
+{
+  K32_modulator* a = (new clocked<K32_mod_sinus>)->period(1000)->play();
+  K32_modulator* b = (new clocked<K32_mod_sinus>)->period(1000)->play();
+
+  for (simTime = 0; simTime <= 20000; simTime++)
+  {
+    if (simTime == 2003) a->period(600);
+    if (simTime == 2011) b->period(600);
+    if (simTime == 7004) a->faster();
+    if (simTime == 7029) b->faster();
+    if (simTime == 12001) a->slower()->slower();
+    if (simTime == 12013) b->slower()->slower();
+
+    if (simTime % 10 == 0) frame(a);
+    if (simTime % 7 == 0) frame(b);
+
+    if (simTime % 70 == 0 && simTime > 0) {
+      int p = a->period();
+      CHECK_EQ(b->period(), p);
+      CHECK_EQ(a->position(), simTime % p);
+      CHECK_EQ(b->position(), simTime % p);
+      CHECK_EQ(a->progress16(), b->progress16());
+      CHECK_EQ(a->periodCount(), b->periodCount());
+    }
+  }
+  delete a;
+  delete b;
+}
+
+// GRAPH: period halved by an upstream modulator, progress does not jump
+static void testSweep()
+{
+  K32_modulator* mod = (new clocked<K32_mod_sawtooth>)->period(1000)->play();
+
+  simTime = 0;
+  frame(mod);
+  int last = mod->progress16();
+  for (simTime = 10; simTime <= 5000; simTime += 10)
+  {
+    if (simTime > 2000) mod->input(MOD_PERIOD, 127);      // period 1000 -> 500
+    frame(mod);
+    int progress = mod->progress16();
+    int step = (uint16_t)(progress - last);
+    CHECK(step > 0 && step <= 65536 * 10 / 500 + 2);
+    last = progress;
+  }
+  delete mod;
+}
+
+// USERS vs RENDER: commands replace, patch and remove modulators while frames are rendered
+static void testReplace()
+{
+  K32_fixture* fix = new K32_fixture(144);
+  K32_anim* anim = (new K32_anim_color())->setup(fix);
+  anim->push(255, 0, 0, 0);
+  anim->play();
+
+  std::atomic<bool> running {true};
+  std::atomic<int> frames {0};
+  std::thread render([&]{
+    while (running) {
+      if (anim->modulate()) anim->render();
+      anim->awake();
+      anim->loop(true);
+      frames++;
+    }
+  });
+
+  for (int i = 0; i < 5000; i++) {
+    anim->mod("wave", new K32_mod_sinus, true)->period(100)->wavelength((i % 2) ? 20 : 0);
+    anim->mod("lfo", new K32_mod_triangle, true);
+    if (i % 3 == 0) anim->patch("lfo", "wave", MOD_PERIOD);
+    if (i % 7 == 0) anim->unmod(true);
+  }
+  running = false;
+  render.join();
+
+  CHECK(frames > 0);
+  CHECK(anim->hasmod("wave"));
+  anim->unmod(true);
+  CHECK(!anim->hasmod("wave"));
+}
+
+int main(int argc, char** argv)
+{
+  setenv("K32_HOST_QUIET", "1", 0);
+  Serial.begin(115200);
+
+  testGetters();
+  testPhase();
+  testSweep();
+  testReplace();
+
+  return checkDone("modulator");
+}
@@ -0,0 +1,120 @@
+/*
+  test_router.cpp
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Order routing (K32-core K32_router.h) with 32 bit FNV-1a keys:
+    routes, modules and listeners are found from the keys hashed when the order is parsed
+    two names with the same key: the second one is refused at registration,
+    and an order on an unregistered name never reaches the handler of its key twin
+*/
+
+#include <Arduino.h>
+#include "K32_router.h"
+#include "class/K32_module.h"
+#include "check.h"
+
+// same FNV-1a hash, found by brute force
+#define TWIN_ROUTE_A    "lgmxifi"     // test/lgmxifi
+#define TWIN_ROUTE_B    "tirtaea"     // test/tirtaea
+#define TWIN_NAME_A     "agckeow"
+#define TWIN_NAME_B     "ihszndk"
+
+static int called[4];
+
+static void handlerA(K32_module* m, Orderz* o)   { called[0]++; }
+static void handlerB(K32_module* m, Orderz* o)   { called[1]++; }
+static void listenerA(Orderz* o)                  { called[2]++; }
+static void listenerB(Orderz* o)                  { called[3]++; }
+
+static routeHandler handlerOf(K32_router* router, const char* path) {
+  Orderz order(path, true);
+  routeEntry* route = router->route(&order);
+  return route ? route->handler : nullptr;
+}
+
+static void testTwins()
+{
+  CHECK_EQ(k32key("test/" TWIN_ROUTE_A), k32key("test/" TWIN_ROUTE_B));
+  CHECK_EQ(k32key(TWIN_NAME_A), k32key(TWIN_NAME_B));
+}
+
+// ROUTES: subaction, action, twin path
+static void testRoutes()
+{
+  K32_router* router = new K32_router();
+  K32_module* test = new K32_module("test");
+
+  test->route(TWIN_ROUTE_A, handlerA);            // pending until linked
+  test->link(nullptr, router);
+  test->route("master/less", handlerB);
+
+  CHECK(handlerOf(router, "test/" TWIN_ROUTE_A) == handlerA);
+  CHECK(handlerOf(router, "test/" TWIN_ROUTE_A "/sub") == handlerA);
+  CHECK(handlerOf(router, "test/master/less") == handlerB);
+  CHECK(handlerOf(router, "test/master") == nullptr);
+  CHECK(handlerOf(router, "test/" TWIN_ROUTE_B) == nullptr);
+
+  // twin refused, first one kept
+  test->route(TWIN_ROUTE_B, handlerB);
+  CHECK(handlerOf(router, "test/" TWIN_ROUTE_A) == handlerA);
+  CHECK(handlerOf(router, "test/" TWIN_ROUTE_B) == nullptr);
+
+  // same path again replaces handler
+  test->route(TWIN_ROUTE_A, handlerB);
+  CHECK(handlerOf(router, "test/" TWIN_ROUTE_A) == handlerB);
+
+  delete test;
+  delete router;
+}
+
+// MODULES: engine name, twin name
+static void testModules()
+{
+  K32_router* router = new K32_router();
+  K32_module* a = new K32_module(TWIN_NAME_A);
+  K32_module* b = new K32_module(TWIN_NAME_B);
+
+  a->link(nullptr, router);
+  b->link(nullptr, router);
+  CHECK(router->module(TWIN_NAME_A) == a);
+  CHECK(router->module(TWIN_NAME_B) == nullptr);
+
+  Orderz order(TWIN_NAME_B "/action", true);
+  CHECK(router->module(order.engineKey, order.engine) == nullptr);
+
+  delete a;
+  delete b;
+  delete router;
+}
+
+// LISTENERS: several on the same event, twin event
+static void testListeners()
+{
+  K32_router* router = new K32_router();
+  router->listen(TWIN_NAME_A, listenerA);
+  router->listen(TWIN_NAME_A, listenerA);
+  router->listen(TWIN_NAME_B, listenerB);
+
+  Orderz a(TWIN_NAME_A "/action");
+  Orderz b(TWIN_NAME_B "/action");
+  router->emit(&a);
+  router->emit(&b);
+  CHECK_EQ(called[2], 2);
+  CHECK_EQ(called[3], 0);
+
+  delete router;
+}
+
+int main(int argc, char** argv)
+{
+  setenv("K32_HOST_QUIET", "1", 0);
+  Serial.begin(115200);
+
+  testTwins();
+  testRoutes();
+  testModules();
+  testListeners();
+
+  return checkDone("router");
+}
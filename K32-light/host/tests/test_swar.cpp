@@ -0,0 +1,207 @@
+/*
+  test_swar.cpp
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Packed color math (_libfast/swar.h, blend.h) is bit-exact with the per-channel CRGBW / lib8tion ops:
+    every byte pair (and every lerp fraction) in every lane
+    random words, and spans against a CRGBW loop
+*/
+
+#include <Arduino.h>
+#include <random>
+#include "_libfast/crgbw.h"
+#include "_libfast/blend.h"
+#include "check.h"
+
+static std::mt19937 rng(32);
+
+static uint32_t word(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+  return r | (g << 8) | (b << 16) | ((uint32_t)w << 24);
+}
+
+// CRGBW of a packed word, and back
+static CRGBW crgbw(uint32_t a) {
+  pixelColor_t p; p.num = a;
+  return CRGBW(p);
+}
+
+static uint32_t packed(const CRGBW& c) {
+  pixelColor_t p = c;
+  return p.num;
+}
+
+
+//
+// REFERENCE: per channel, as CRGBW does it
+//
+
+static uint32_t refAdd(uint32_t a, uint32_t b)                { CRGBW c = crgbw(a); c += crgbw(b); return packed(c); }
+static uint32_t refMax(uint32_t a, uint32_t b)                { CRGBW c = crgbw(a); c |= crgbw(b); return packed(c); }
+static uint32_t refMin(uint32_t a, uint32_t b)                { CRGBW c = crgbw(a); c &= crgbw(b); return packed(c); }
+static uint32_t refScale(uint32_t a, uint8_t s)               { CRGBW c = crgbw(a); c.nscale8(s); return packed(c); }
+static uint32_t refVideo(uint32_t a, uint8_t s)               { CRGBW c = crgbw(a); c %= s; return packed(c); }
+static uint32_t refFade(uint32_t a, uint8_t f)                { CRGBW c = crgbw(a); c.fadeToBlackBy(f); return packed(c); }
+static uint32_t refLerp(uint32_t a, uint32_t b, uint8_t f)    { return packed(crgbw(a).lerp8(crgbw(b), f)); }
+
+static uint32_t refMultiply(uint32_t a, uint32_t b) {
+  pixelColor_t pa, pb, r; pa.num = a; pb.num = b;
+  r.r = scale8(pa.r, pb.r); r.g = scale8(pa.g, pb.g); r.b = scale8(pa.b, pb.b); r.w = scale8(pa.w, pb.w);
+  return r.num;
+}
+
+
+//
+// EXHAUSTIVE: each byte pair lands in every lane (a, b, 255-a, 255-b)
+//
+
+static void testPairs()
+{
+  for (int x = 0; x < 256; x++)
+    for (int y = 0; y < 256; y++)
+    {
+      uint32_t a = word(x, y, 255-x, 255-y);
+      uint32_t b = word(y, x, 255-y, 255-x);
+
+      CHECK_EQ(pixelAdd(a, b), refAdd(a, b));
+      CHECK_EQ(pixelMax(a, b), refMax(a, b));
+      CHECK_EQ(pixelMin(a, b), refMin(a, b));
+      CHECK_EQ(pixelScale(a, y), refScale(a, y));
+      CHECK_EQ(pixelScaleVideo(a, y), refVideo(a, y));
+      CHECK_EQ(pixelMultiply(a, b), refMultiply(a, b));
+    }
+}
+
+// every (a, b, frac)
+static void testLerp()
+{
+  int failed = checkFailed;
+  for (int x = 0; x < 256; x++)
+    for (int y = 0; y < 256; y++)
+    {
+      uint32_t a = word(x, y, 255-x, 255-y);
+      uint32_t b = word(y, x, 255-y, 255-x);
+      for (int f = 0; f < 256; f++)
+        if (pixelLerp(a, b, f) != refLerp(a, b, f)) CHECK_EQ(pixelLerp(a, b, f), refLerp(a, b, f));
+      if (checkFailed > failed) return;
+    }
+  CHECK(true);
+}
+
+
+//
+// RANDOM words
+//
+
+static void testWords()
+{
+  for (int k = 0; k < 1000000; k++)
+  {
+    uint32_t a = rng(), b = rng();
+    uint8_t s = rng();
+    CHECK_EQ(pixelAdd(a, b), refAdd(a, b));
+    CHECK_EQ(pixelMax(a, b), refMax(a, b));
+    CHECK_EQ(pixelMin(a, b), refMin(a, b));
+    CHECK_EQ(pixelScale(a, s), refScale(a, s));
+    CHECK_EQ(pixelScaleVideo(a, s), refVideo(a, s));
+    CHECK_EQ(pixelLerp(a, b, s), refLerp(a, b, s));
+    CHECK_EQ(pixelMultiply(a, b), refMultiply(a, b));
+  }
+}
+
+
+//
+// SPANS against CRGBW loop
+//
+
+#define SPAN  512
+
+static pixelColor_t dst[SPAN], src[SPAN], expect[SPAN];
+
+static void randomSpans() {
+  for (int i = 0; i < SPAN; i++) {
+    dst[i].num = rng();
+    src[i].num = rng();
+  }
+}
+
+static void checkSpan(const char* name) {
+  int wrong = 0;
+  for (int i = 0; i < SPAN; i++) if (dst[i].num != expect[i].num) wrong++;
+  if (wrong) printf("  span %s: %d pixels differ\n", name, wrong);
+  CHECK_EQ(wrong, 0);
+}
+
+static void testSpans()
+{
+  for (int round = 0; round < 16; round++)
+  {
+    uint8_t s = rng();
+
+    randomSpans();
+    for (int i = 0; i < SPAN; i++) expect[i].num = refScale(dst[i].num, s);
+    spanScale(dst, SPAN, s);
+    checkSpan("scale");
+
+    randomSpans();
+    uint8_t scale[SPAN];
+    for (int i = 0; i < SPAN; i++) scale[i] = rng();
+    for (int i = 0; i < SPAN; i++) expect[i].num = refScale(dst[i].num, scale[i]);
+    spanScale(dst, scale, SPAN);
+    checkSpan("scale by pixel");
+
+    randomSpans();
+    for (int i = 0; i < SPAN; i++) expect[i].num = refVideo(dst[i].num, s);
+    spanScaleVideo(dst, SPAN, s);
+    checkSpan("video");
+
+    randomSpans();
+    for (int i = 0; i < SPAN; i++) expect[i].num = refVideo(src[i].num, s);
+    spanScaleVideo(dst, src, SPAN, s);
+    checkSpan("video copy");
+
+    randomSpans();
+    for (int i = 0; i < SPAN; i++) expect[i].num = refFade(dst[i].num, s);
+    spanFade(dst, SPAN, s);
+    checkSpan("fade");
+
+    randomSpans();
+    for (int i = 0; i < SPAN; i++) expect[i].num = refAdd(dst[i].num, src[i].num);
+    spanAdd(dst, src, SPAN);
+    checkSpan("add");
+
+    randomSpans();
+    for (int i = 0; i < SPAN; i++) expect[i].num = refMax(dst[i].num, src[i].num);
+    spanMax(dst, src, SPAN);
+    checkSpan("max");
+
+    randomSpans();
+    for (int i = 0; i < SPAN; i++) expect[i].num = refMin(dst[i].num, src[i].num);
+    spanMin(dst, src, SPAN);
+    checkSpan("min");
+
+    randomSpans();
+    for (int i = 0; i < SPAN; i++) expect[i].num = refLerp(dst[i].num, src[i].num, s);
+    spanLerp(dst, src, SPAN, s);
+    checkSpan("lerp");
+
+    randomSpans();
+    for (int i = 0; i < SPAN; i++) expect[i].num = refMultiply(dst[i].num, src[i].num);
+    blendSpan(dst, src, SPAN, BLEND_MULTIPLY, 255);
+    checkSpan("blend multiply");
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testPairs();
+  testLerp();
+  testWords();
+  testSpans();
+
+#ifdef LIBFAST_SCALAR
+  return checkDone("swar (scalar)");
+#else
+  return checkDone("swar");
+#endif
+}
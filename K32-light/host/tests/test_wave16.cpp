@@ -0,0 +1,128 @@
+/*
+  test_wave16.cpp
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Fixed point waveforms (_libfast/wave16.h) against the float formulas modulators used before:
+    sine16 / triangle16 against their float curve on every phase
+    modulator values every ms of a few periods and ranges: at most 1 LSB (8 bit level) from the float value
+*/
+
+#include <Arduino.h>
+#include "K32_light.h"
+#include "check.h"
+
+// modulator on a test clock
+static int simTime = 0;
+
+template<typename M>
+class clocked : public M {
+  public:
+    int time() { return simTime; }
+};
+
+static int data[ANIM_DATA_SLOTS];
+
+static const int periods[] = {1, 7, 100, 333, 1000, 2500, 60000};
+static const int ranges[][2] = {{0, 255}, {10, 200}, {100, 101}, {0, 0}, {200, 50}};
+
+
+//
+// WAVEFORMS: level 0 -> 65535 on every phase
+//
+
+static void testShapes()
+{
+  int worstSine = 0, worstTri = 0;
+  for (int phase = 0; phase < 65536; phase++)
+  {
+    double x = phase / 65536.0;
+    int sine = lround(32767.5 + 32767.5 * sin(2 * PI * x));
+    int tri = lround(65535 * 2 * ((x > 0.5) ? 1 - x : x));
+    worstSine = max(worstSine, abs(sine16(phase) - sine));
+    worstTri = max(worstTri, abs(triangle16(phase) - tri));
+    CHECK_EQ(sawtooth16(phase), phase);
+  }
+  CHECK(worstSine <= 8);
+  CHECK(worstTri <= 2);
+
+  // one period wraps continuously, peaks reached
+  CHECK_EQ(WAVE16_SINE[256], WAVE16_SINE[0]);
+  CHECK(abs(sine16(65535) - sine16(0)) <= 4);
+  CHECK_EQ(sine16(16384), 65535);
+  CHECK_EQ(sine16(49152), 0);
+  CHECK_EQ(scale16level(65535, 255), 255);
+  CHECK_EQ(scale16level(0, 255), 0);
+}
+
+
+//
+// MODULATORS: value() every ms against the float formula on the same progress
+//
+
+typedef double (*floatWave)(double progress, int mini, int maxi);
+
+static double sinusRef(double x, int mini, int maxi)     { return (0.5 + 0.5 * sin(2 * PI * x)) * (maxi - mini) + mini; }
+static double triangleRef(double x, int mini, int maxi)  { return 2 * ((x > 0.5) ? 1 - x : x) * (maxi - mini) + mini; }
+static double sawtoothRef(double x, int mini, int maxi)  { return x * (maxi - mini) + mini; }
+static double isawtoothRef(double x, int mini, int maxi) { return maxi - x * (maxi - mini); }
+
+template<typename M>
+static void testWave(const char* name, floatWave ref)
+{
+  int worst = 0;
+  for (int period : periods)
+    for (auto& range : ranges)
+    {
+      K32_modulator* mod = (new clocked<M>)->period(period)->mini(range[0])->maxi(range[1])->play();
+      for (simTime = 0; simTime < 2 * period; simTime++)
+      {
+        mod->run(data);
+        double x = (double)(simTime % period) / period;
+        int expect = min(255, max(0, (int)ref(x, range[0], range[1])));
+        worst = max(worst, abs(mod->output() - expect));
+      }
+      delete mod;
+    }
+  if (worst > 1) printf("  %s: %d LSB from float\n", name, worst);
+  CHECK(worst <= 1);
+}
+
+// fade in / out: from play() to end of period, then held
+template<typename M>
+static void testFade(const char* name, floatWave ref, bool in)
+{
+  int worst = 0;
+  for (int period : periods)
+    for (auto& range : ranges)
+    {
+      K32_modulator* mod = (new clocked<M>)->period(period)->mini(range[0])->maxi(range[1])->play();
+      for (simTime = 0; simTime < period; simTime++)
+      {
+        mod->run(data);
+        int expect = min(255, max(0, (int)ref((double)simTime / period, range[0], range[1])));
+        worst = max(worst, abs(mod->output() - expect));
+      }
+      mod->run(data);
+      CHECK_EQ(mod->value(), in ? range[1] : range[0]);
+      delete mod;
+    }
+  if (worst > 1) printf("  %s: %d LSB from float\n", name, worst);
+  CHECK(worst <= 1);
+}
+
+int main(int argc, char** argv)
+{
+  setenv("K32_HOST_QUIET", "1", 0);
+  Serial.begin(115200);
+
+  testShapes();
+  testWave<K32_mod_sinus>("sinus", sinusRef);
+  testWave<K32_mod_triangle>("triangle", triangleRef);
+  testWave<K32_mod_sawtooth>("sawtooth", sawtoothRef);
+  testWave<K32_mod_isawtooth>("isawtooth", isawtoothRef);
+  testFade<K32_mod_fadein>("fadein", sawtoothRef, true);
+  testFade<K32_mod_fadeout>("fadeout", isawtoothRef, false);
+
+  return checkDone("wave16");
+}
@@ -0,0 +1,134 @@
+/*
+  virtual_leds.cpp
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+*/
+
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include "virtual_leds.h"
+
+struct virtualStrand {
+  strand_t strand;
+  pixelColor_t* last;
+  std::atomic<uint32_t> frames;
+};
+
+static virtualStrand strands[VIRTUAL_LEDS_MAXSTRANDS];
+static int strandCount = 0;
+static FILE* recordTo = nullptr;
+static bool wireTime = false;
+static std::mutex recordLock;
+
+static virtualStrand* find(strand_t* s) 
+{
+  for (int k=0; k<strandCount; k++)
+    if (&strands[k].strand == s) return &strands[k];
+  return nullptr;
+}
+
+void virtualLeds_record(FILE* out) {
+  std::lock_guard<std::mutex> lock(recordLock);
+  recordTo = out;
+}
+
+void virtualLeds_wire(bool enable) {
+  wireTime = enable;
+}
+
+int virtualLeds_strands() {
+  return strandCount;
+}
+
+strand_t* virtualLeds_strand(int k) {
+  return (k >= 0 && k < strandCount) ? &strands[k].strand : nullptr;
+}
+
+uint32_t virtualLeds_frames(strand_t* s) {
+  virtualStrand* v = find(s);
+  return v ? v->frames.load() : 0;
+}
+
+void virtualLeds_resetFrames() {
+  for (int k=0; k<strandCount; k++) strands[k].frames = 0;
+}
+
+const pixelColor_t* virtualLeds_pixels(strand_t* s) {
+  virtualStrand* v = find(s);
+  return v ? v->last : nullptr;
+}
+
+
+//
+// digitalLeds API
+//
+
+int digitalLeds_init() {
+  return 0;
+}
+
+// as on target: nullptr if the RMT channel is already used (chained memory blocks are not simulated)
+strand_t* digitalLeds_addStrand(strand_t s) 
+{
+  if (strandCount >= VIRTUAL_LEDS_MAXSTRANDS) return nullptr;
+  for (int k=0; k<strandCount; k++)
+    if (strands[k].strand.rmtChannel == s.rmtChannel) return nullptr;
+  virtualStrand* v = &strands[strandCount];
+  v->strand = s;
+  v->strand.pixels = static_cast<pixelColor_t*>(calloc(s.numPixels, sizeof(pixelColor_t)));
+  v->last = static_cast<pixelColor_t*>(calloc(s.numPixels, sizeof(pixelColor_t)));
+  v->frames = 0;
+  strandCount += 1;
+  return &v->strand;
+}
+
+// copy strand pixels to its last frame, and record it
+static int push(strand_t* s) 
+{
+  virtualStrand* v = find(s);
+  if (!v) return -1;
+
+  memcpy(v->last, s->pixels, s->numPixels * sizeof(pixelColor_t));
+  v->frames += 1;
+
+  std::lock_guard<std::mutex> lock(recordLock);
+  if (recordTo) {
+    virtualFrame header = {(uint32_t)(v - strands), (uint32_t)micros(), (uint32_t)s->numPixels};
+    fwrite(&header, sizeof header, 1, recordTo);
+    fwrite(v->last, sizeof(pixelColor_t), s->numPixels, recordTo);
+  }
+  return 0;
+}
+
+int digitalLeds_updatePixels(strand_t* s) 
+{
+  if (push(s) < 0) return -1;
+  if (wireTime) delayMicroseconds(s->numPixels * 30 + 50);
+  return 0;
+}
+
+// strands are sent together: wire time is the longest one
+int digitalLeds_drawPixels(strand_t** s, int count) 
+{
+  int longest = 0;
+  for (int k=0; k<count; k++) {
+    push(s[k]);
+    longest = max(longest, s[k]->numPixels);
+  }
+  if (wireTime) delayMicroseconds(longest * 30 + 50);
+  return 0;
+}
+
+void digitalLeds_resetPixels(strand_t* s) {
+  memset(s->pixels, 0, s->numPixels * sizeof(pixelColor_t));
+  digitalLeds_updatePixels(s);
+}
+
+// calibration and RMT memory are applied by the packer on target: nothing to do here
+void digitalLeds_setGamma(strand_t* s, int gamma) {}
+void digitalLeds_setBrightness(strand_t* s, int brightLimit) { s->brightLimit = brightLimit; }
+void digitalLeds_setBalance(strand_t* s, uint8_t red, uint8_t green, uint8_t blue, uint8_t white) {}
+int digitalLeds_setColorOrder(strand_t* s, int order) { return (order >= 0 && order < (int)(sizeof(colorOrderAll) / sizeof(colorOrderAll[0]))) ? 0 : -1; }
+int digitalLeds_setEncoder(strand_t* s, int enable) { return 0; }
+int digitalLeds_setMemBlocks(strand_t* s, int blocks) { return 0; }
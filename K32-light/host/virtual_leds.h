@@ -0,0 +1,32 @@
+/*
+  virtual_leds.h
+  Created by Thomas BOHL, october 2026.
+  Released under GPL v3.0
+
+  Host replacement of _librmt (digitalLeds_*): strands are memory, every pushed frame is counted and can be recorded
+*/
+#ifndef virtual_leds_h
+#define virtual_leds_h
+
+#include <stdio.h>
+#include "_librmt/esp32_digital_led_lib.h"
+
+#define VIRTUAL_LEDS_MAXSTRANDS   8
+
+// record header, followed by count pixelColor_t (r, g, b, w)
+struct virtualFrame {
+  uint32_t strand;        // strand index (addStrand order)
+  uint32_t time;          // micros() at push
+  uint32_t count;         // pixels
+};
+
+void virtualLeds_record(FILE* out);                     // write every pushed frame to out (nullptr: stop)
+void virtualLeds_wire(bool enable);                     // push takes WS2812 wire time (30us / pixel)
+
+int virtualLeds_strands();
+strand_t* virtualLeds_strand(int k);
+uint32_t virtualLeds_frames(strand_t* strand);          // frames pushed to strand
+void virtualLeds_resetFrames();                         // restart frames pushed count (with K32_light::resetStats)
+const pixelColor_t* virtualLeds_pixels(strand_t* strand);   // last frame pushed to strand
+
+#endif
@@ -8,10 +8,36 @@
 
 #define ANIM_DATA_SLOTS  32
 #define ANIM_MOD_SLOTS  16
+#define ANIM_MOD_LINKS  32
 
+#include <atomic>
+#include <type_traits>
 #include "fixtures/K32_fixture.h"
+#include "_libfast/blend.h"
 #include "K32_modulator.h"
 
+enum animState : uint8_t { ANIM_STOPPED, ANIM_STARTING, ANIM_PLAYING };
+
+// MODULATION GRAPH: src modulator output -> dst modulator param
+struct modLink {
+  K32_modulator* src;
+  K32_modulator* dst;
+  uint8_t target;
+};
+
+// MODULATION GRAPH compiled: modulators in run order, each followed by its outputs (flat arrays, slot indexes)
+struct modFlow {
+  uint8_t dst;
+  uint8_t target;
+};
+
+struct modGraph {
+  uint8_t order[ANIM_MOD_SLOTS];
+  uint8_t flowStart[ANIM_MOD_SLOTS+1];      // outputs of order[i]: flow[flowStart[i]] -> flow[flowStart[i+1]-1]
+  modFlow flow[ANIM_MOD_LINKS];
+  int count = 0;
+};
+
 
 //
 // BASE ANIM
@@ -26,18 +52,15 @@ class K32_anim {
       for (int k=0; k<ANIM_MOD_SLOTS; k++)
         this->_modulators[k] = NULL;
 
-      this->newData = xSemaphoreCreateBinary();
-      this->bufferInUse = xSemaphoreCreateBinary();
-      xSemaphoreTake(this->newData, 1);
-      xSemaphoreGive(this->bufferInUse);
+      this->dataLock = xSemaphoreCreateMutex();
 
       this->wait_lock = xSemaphoreCreateBinary();
       xSemaphoreGive(this->wait_lock);
     }
 
     virtual ~K32_anim() {
-      vQueueDelete(this->newData);
-      vQueueDelete(this->bufferInUse);
+      if (this->_layer) free(this->_layer);
+      vQueueDelete(this->dataLock);
       vQueueDelete(this->wait_lock);
     }
 
@@ -73,10 +96,10 @@ class K32_anim {
 
     // is playing ?
     bool isPlaying() {
-      return this->animateHandle != NULL;
+      return this->_state.load() != ANIM_STOPPED;
     }
 
-    // start animate thread
+    // start playing: init() and draw() are called by the render task (see K32_light)
     K32_anim* play(int timeout = 0) 
     {
       if (this->_strip == NULL) {
@@ -88,21 +111,18 @@ class K32_anim {
       if (this->isPlaying()) return this;
 
       xSemaphoreTake(this->wait_lock, portMAX_DELAY);
-      xSemaphoreTake(this->bufferInUse, portMAX_DELAY);
-      xTaskCreate( this->animate,           // function
-                    "anim_task",            // task name
-                    5000,                   // stack memory
-                    (void*)this,            // args
-                    3,                      // priority
-                    &this->animateHandle ); // handler
+      this->_state = ANIM_STARTING;
+      renderWake();
       LOGF("ANIM: %s play \n", this->name().c_str() );
       
       return this;
     }
 
-    // stop animation
+    // stop animation (must not be called from draw(), use loop(false) there)
     void stop() { 
+      if (!this->isPlaying()) return;
       this->_stopAt = 1; 
+      renderWake();
       this->wait(); // !!! stop might hang an entire frame (but it safer to prevent clear conflict)
     }
 
@@ -134,7 +154,11 @@ class K32_anim {
         return modulator;
       }
       
+      xSemaphoreTake(this->dataLock, portMAX_DELAY);          // render task walks modulators under dataLock
       this->_modulators[i] = modulator;
+      this->_graphDirty = true;
+      xSemaphoreGive(this->dataLock);
+      renderWake();
       // LOGF2("ANIM: %s register mod %s \n", this->name(), modulator->name()); 
       
       if (playNow) modulator->play();
@@ -148,15 +172,15 @@ class K32_anim {
       modulator->name(modName);
 
       // delete already existing mod with this name (replace)
+      xSemaphoreTake(this->dataLock, portMAX_DELAY);
       for (int k=0; k<ANIM_MOD_SLOTS; k++)
         if(this->_modulators[k] != NULL) 
           if (this->_modulators[k]->name() == modName)
           {
             LOGF("ANIM: %s replaced !\n", this->_modulators[k]->name());
-            this->_modulators[k]->stop();
-            delete this->_modulators[k];
-            this->_modulators[k] = NULL;
+            this->remove(k);
           }
+      xSemaphoreGive(this->dataLock);
 
       return this->mod( modulator, playNow );
     }
@@ -214,19 +238,131 @@ class K32_anim {
     // remove Anonym only / All modulators
     K32_anim* unmod(bool all=false)
     {
+      xSemaphoreTake(this->dataLock, portMAX_DELAY);
       for (int k=0; k<ANIM_MOD_SLOTS; k++)
         if(this->_modulators[k] != NULL) 
           if (all || this->_modulators[k]->name() == "?")
           {
             // LOGF("ANIM: %s unmoded !\n", this->_modulators[k]->name());
-            this->_modulators[k]->stop();
-            delete this->_modulators[k];
-            this->_modulators[k] = NULL;
+            this->remove(k);
           }
+      xSemaphoreGive(this->dataLock);
       // LOGF("ANIM: %s unmoded !\n", this->name());
       return this;
     }
 
+    // MODULATION GRAPH: output of src scales target param of dst (both registered on this anim), every frame
+    //   anim->patch(lfo2, lfo1, MOD_PERIOD)    lfo1 speed is swept by lfo2
+    // links making a loop are refused
+    K32_anim* patch(K32_modulator* src, K32_modulator* dst, uint8_t target) 
+    {
+      if (target >= MOD_TARGETS) return this;
+      xSemaphoreTake(this->dataLock, portMAX_DELAY);
+      if (this->_linkCount >= ANIM_MOD_LINKS) LOG("ERROR: no more slot available to patch modulator");
+      else {
+        this->_links[this->_linkCount] = {src, dst, target};
+        this->_linkCount += 1;
+
+        modGraph test;
+        if (this->compile(test)) {
+          this->_graphDirty = true;
+          renderWake();
+        }
+        else {
+          this->_linkCount -= 1;
+          LOGF("ANIM: %s patch refused, modulation loop\n", this->name().c_str());
+        }
+      }
+      xSemaphoreGive(this->dataLock);
+      return this;
+    }
+
+    K32_anim* patch(String src, String dst, uint8_t target) {
+      return this->patch(this->mod(src), this->mod(dst), target);
+    }
+
+    // remove all links from / to modulator
+    K32_anim* unpatch(K32_modulator* modulator) 
+    {
+      xSemaphoreTake(this->dataLock, portMAX_DELAY);
+      this->unlink(modulator);
+      xSemaphoreGive(this->dataLock);
+      return this;
+    }
+
+
+    // ANIM LAYER
+    //
+
+    // draw into a private layer (anim size, clipped to fixture), blended on the fixture by K32_light every frame.
+    // Call after setup and before play. Layers are blended in anim registration order, over black: 
+    // anims drawing directly on a layered fixture are overwritten.
+    K32_anim* layer(blendMode mode = BLEND_OVER, uint8_t opacity = 255) 
+    {
+      if (this->_strip == NULL) {
+        LOG("ERROR: animation, you need to call setup before layer !");
+        return this;
+      }
+      
+      int start = max(0, this->_offset);
+      int stop = min(this->_strip->size(), this->_offset + this->_size);
+      if (stop <= start) {
+        LOG("ERROR: animation, layer is outside of fixture");
+        return this;
+      }
+
+      if (!this->_layer || this->_layerCount != stop - start) {
+        if (this->_layer) free(this->_layer);
+        this->_layer = static_cast<pixelColor_t*>(malloc((stop - start) * sizeof(pixelColor_t)));
+      }
+      memset(this->_layer, 0, (stop - start) * sizeof(pixelColor_t));
+      this->_layerStart = start;
+      this->_layerCount = stop - start;
+      this->_blendMode = mode;
+      return this->opacity(opacity);
+    }
+
+    bool layered() {
+      return this->_layer != nullptr;
+    }
+
+    K32_anim* blend(blendMode mode) {
+      this->_blendMode = mode;
+      this->_layerChanged = true;
+      renderWake();
+      return this;
+    }
+
+    K32_anim* opacity(uint8_t o) {
+      this->_opacity = o;
+      this->_layerChanged = true;
+      renderWake();
+      return this;
+    }
+    uint8_t opacity() {
+      return this->_opacity;
+    }
+
+    K32_fixture* fixture() {
+      return this->_strip;
+    }
+
+    // COMPOSITOR (see K32_light): layer changed since last call ?
+    bool layerChanged() {
+      return this->_layerChanged.exchange(false);
+    }
+
+    // COMPOSITOR: extend [start, stop[ with layer span
+    void layerSpan(int& start, int& stop) {
+      start = min(start, this->_layerStart);
+      stop = max(stop, this->_layerStart + this->_layerCount);
+    }
+
+    // COMPOSITOR: blend layer onto out (fixture sized frame)
+    void layerBlend(pixelColor_t* out) {
+      blendSpan(&out[this->_layerStart], this->_layer, this->_layerCount, this->_blendMode, this->_opacity);
+    }
+
 
     // ANIM MASTER
     //
@@ -240,44 +376,35 @@ class K32_anim {
 
     // change one element in data
     K32_anim* set(int k, int value) { 
-      xSemaphoreTake(this->bufferInUse, portMAX_DELAY);     // data can be modified only during anim waitData
-      if (k < ANIM_DATA_SLOTS) this->_data[k] = value; 
-      xSemaphoreGive(this->bufferInUse);
+      xSemaphoreTake(this->dataLock, portMAX_DELAY);        // data can't be modified while render task copies it
+      this->write(k, value);
+      xSemaphoreGive(this->dataLock);
       return this;
     }
 
     // new data push (int[], size)
-    K32_anim* push(int* frame, int size) {
-      bool didChange = false;
-      size = min(size, ANIM_DATA_SLOTS);
-      xSemaphoreTake(this->bufferInUse, portMAX_DELAY);     // data can be modified only during anim waitData
-      for(int k=0; k<size; k++) 
-        if (this->_data[k] != frame[k]) {
-          this->_data[k] = frame[k]; 
-          didChange = true;
-        }
-      xSemaphoreGive(this->bufferInUse);
-      if (didChange || !this->_firstDataReceived) xSemaphoreGive(this->newData);
-      return this;
+    K32_anim* push(const int* frame, int size) {
+      xSemaphoreTake(this->dataLock, portMAX_DELAY);        // data can't be modified while render task copies it
+      bool didChange = this->write(frame, size);
+      xSemaphoreGive(this->dataLock);
+      return this->changed(didChange);
     }
     
-    // new data push (uint8_t[], size)
-    K32_anim* push(uint8_t* frame, int size) {
-      int dframe[size];
-      for(int i=0; i<size; i++) dframe[i] = frame[i];
-      return this->push(dframe, size);
-    }
-
-    // new data push (const uint8_t[], size)
+    // new data push (uint8_t[], size): DMX / ArtNet frame
     K32_anim* push(const uint8_t* frame, int size) {
-      int dframe[size];
-      for(int i=0; i<size; i++) dframe[i] = frame[i];
-      return this->push(dframe, size);
+      xSemaphoreTake(this->dataLock, portMAX_DELAY);
+      bool didChange = this->write(frame, size);
+      xSemaphoreGive(this->dataLock);
+      return this->changed(didChange);
     }
 
+    K32_anim* push(int* frame, int size) { return this->push((const int*)frame, size); }
+    K32_anim* push(uint8_t* frame, int size) { return this->push((const uint8_t*)frame, size); }
+
     // refresh data 
     K32_anim* push() {
-      xSemaphoreGive(this->newData);
+      this->_newData = true;
+      renderWake();
       return this;
     }
 
@@ -292,6 +419,107 @@ class K32_anim {
     K32_anim* push(int d0, int d1, int d2, int d3, int d4, int d5, int d6, int d7) { int frame[8] = {d0, d1, d2, d3, d4, d5, d6, d7}; return this->push(frame, 8); }
 
 
+    // FRAME (1/2): called by the render task (see K32_light) once per frame clock tick, 
+    // runs modulators and returns true if a frame must be drawn: new data, modulation change, or pause is over
+    bool modulate() 
+    {
+      uint8_t state = this->_state.load();
+      if (state == ANIM_STOPPED) return false;
+
+      if (state == ANIM_STARTING) 
+      {
+        this->startTime = millis();
+        this->frameCount = 0;
+        this->_stage = 0;
+        this->_paused = false;
+        if (this->_firstDataReceived) this->_newData = true;                       // Not first play -> data can be drawn now !
+        this->init();                                                               // Subclass init hook
+        this->_state = ANIM_PLAYING;
+      }
+
+      this->frameCount++;
+
+      if (this->_stopAt && millis() >= this->_stopAt) {                            // check if we should stop now
+        this->finish();
+        return false;
+      }
+
+      bool triggerDraw;
+      if (this->_paused) {                                                          // resume sequence when pause is over
+        if ((long)(millis() - this->_resumeAt) < 0) return false;
+        this->_paused = false;
+        triggerDraw = true;
+      }
+      else {
+        triggerDraw = this->_newData.exchange(false);
+        if (triggerDraw) this->_firstDataReceived = true;                           // Data has been set at least one time since anim creation
+        else if (!this->_firstDataReceived) return false;                           // Data has never been set -> we can't draw ! 
+      }
+
+      if (this->timed()) triggerDraw = true;                                        // draw() depends on time: every frame
+      else if (!triggerDraw && !this->_graphDirty && !this->modulating()) return false;  // nothing moves: skip copy and modulators
+
+      xSemaphoreTake(this->dataLock, portMAX_DELAY);                               // lock buffer and modulators to prevent external change
+      this->latch();                                                                // copy buffer
+      if (this->_graphDirty) {
+        this->compile(this->_graph);                                                // modulators or links changed
+        this->_graphDirty = false;
+      }
+      
+      modGraph& g = this->_graph;
+      for (int i=0; i<g.count; i++) {
+        K32_modulator* m = this->_modulators[g.order[i]];
+        if (!m) continue;
+        triggerDraw = this->modulateFrame(m) || triggerDraw;                       // run modulators on data
+        for (int f=g.flowStart[i]; f<g.flowStart[i+1]; f++)                       // then feed modulators it modulates
+          if (this->_modulators[g.flow[f].dst])
+            this->_modulators[g.flow[f].dst]->input(g.flow[f].target, m->output());
+      }
+      xSemaphoreGive(this->dataLock);                                               // let data be push and modulators removed by others
+
+      return triggerDraw;
+    }
+
+    // FRAME (2/2): draw data prepared by modulate()
+    void render() 
+    {
+      this->beginDraw();
+      this->drawFrame();                                                            // Subclass draw hook
+      this->spread();                                                               // spatial modulators
+      this->endDraw();
+
+      if (this->_paused) return;                                                    // draw() will be called again after pause
+      this->_stage = 0;
+      if (!this->loop()) this->finish();
+    }
+
+    // FRAME: both steps at once
+    void tick() {
+      if (this->modulate()) this->render();
+    }
+
+    // FRAME CLOCK: does anim need next frame tick ? (render task sleeps if no anim does)
+    bool awake() 
+    {
+      uint8_t state = this->_state.load();
+      if (state == ANIM_STOPPED) return false;
+      if (state == ANIM_STARTING || this->_newData || this->_paused || this->_stopAt || this->_graphDirty) return true;
+      return this->timed() || this->modulating();
+    }
+
+    // any modulator running (compact list of registered modulators, see compile())
+    bool modulating() 
+    {
+      bool running = false;
+      xSemaphoreTake(this->dataLock, portMAX_DELAY);
+      for (int i=0; i<this->_graph.count && !running; i++) {
+        K32_modulator* m = this->_modulators[this->_graph.order[i]];
+        running = (m && m->running());
+      }
+      xSemaphoreGive(this->dataLock);
+      return running;
+    }
+
 
   // PROTECTED
   //
@@ -304,15 +532,24 @@ class K32_anim {
     // this is a prototype, must be defined in specific anim class
     virtual void init() {}
 
+    // override to return true if draw() depends on time, not only on data and modulators: drawn every frame
+    virtual bool timed() { return false; }
+
     // generate frame from data, called by update
     // this is a prototype, must be defined in specific anim class
     virtual void draw (int data[ANIM_DATA_SLOTS]) { LOG("ANIM: nothing to do.."); };
 
-    // pause is like delay, but allow strip refresh
+    // pause is like delay, but never blocks the render task: what has been drawn is shown, 
+    // draw() should return right after, it will be called again in ms with stage() incremented
     void pause(int ms) {
-      this->_strip->unlock();
-      delay(ms);
-      this->_strip->lock();
+      this->_resumeAt = millis() + ms;
+      this->_paused = true;
+      this->_stage += 1;
+    }
+
+    // position in a paused draw sequence: 0 on first call, +1 after each pause()
+    int stage() {
+      return this->_stage;
     }
 
     // DRAW ON STRIP
@@ -320,18 +557,101 @@ class K32_anim {
 
     // draw pix
     void pixel(int pix, CRGBW color)  {
-      if (pix < this->_size)
-        this->_strip->pix( pix + this->_offset, color % this->_master);
+      if (pix >= 0 && pix < this->_size) {
+        if (this->_frame) {
+          pix += this->_offset;
+          if (pix >= 0 && pix < this->_strip->size()) this->_frame[pix] = color % this->_master;
+        }
+        else this->_strip->pix( pix + this->_offset, color % this->_master);
+      }
     }
 
     // draw multiple pix
     void pixel(int pixStart, int count, CRGBW color)  {
-      this->_strip->pix( pixStart + this->_offset, count, color % this->_master);
+      int skip;
+      if (!this->span(pixStart, count, skip)) return;
+
+      pixelColor_t c = color % this->_master;
+      if (this->_frame) 
+        for (int i = pixStart; i < pixStart+count; i++) this->_frame[i] = c;
+      else this->_strip->pix( pixStart, count, c);
     }
 
     // draw all
     void all(CRGBW color) {
-      this->_strip->pix( this->_offset, this->_size, color % this->_master);
+      this->pixel(0, this->_size, color);
+    }
+
+    // DRAW SPANS
+    //
+
+    // draw array of colors
+    void pixels(int pixStart, int count, const CRGBW* colors) {
+      int skip;
+      if (!this->span(pixStart, count, skip)) return;
+      colors += skip - pixStart;
+
+      if (this->_frame) 
+        spanScaleVideo(&this->_frame[pixStart], reinterpret_cast<const pixelColor_t*>(&colors[pixStart]), count, this->_master);
+      else {
+        uint8_t m = this->_master;
+        this->_strip->map(pixStart, count, [colors, m](int i, pixelColor_t c) -> pixelColor_t { return colors[i] % m; });
+      }
+    }
+
+    // draw gradient from -> to
+    void gradient(int pixStart, int count, CRGBW from, CRGBW to) {
+      int first = pixStart + this->_offset;
+      int length = count;
+      int skip;
+      if (!this->span(pixStart, count, skip)) return;
+
+      uint8_t m = this->_master;
+      auto grad = [first, length, from, to, m](int i, pixelColor_t c) -> pixelColor_t { 
+        return from.lerp8(to, (length > 1) ? (i-first)*255/(length-1) : 0) % m; 
+      };
+
+      if (this->_frame) 
+        for (int i = pixStart; i < pixStart+count; i++) this->_frame[i] = grad(i, this->_frame[i]);
+      else this->_strip->map(pixStart, count, grad);
+    }
+
+    // apply fn on each pixel:  CRGBW fn(int pix, CRGBW color)
+    // pix is relative to the anim, color is the current pixel value (master already applied)
+    template<typename F>
+    void map(int pixStart, int count, F fn) {
+      int skip;
+      if (!this->span(pixStart, count, skip)) return;
+
+      int offset = this->_offset;
+      uint8_t m = this->_master;
+      auto apply = [&fn, offset, m](int i, pixelColor_t c) -> pixelColor_t { return fn(i-offset, CRGBW(c)) % m; };
+
+      if (this->_frame) 
+        for (int i = pixStart; i < pixStart+count; i++) this->_frame[i] = apply(i, this->_frame[i]);
+      else this->_strip->map(pixStart, count, apply);
+    }
+
+    // copy count pixels from src fixture (starting at srcStart)
+    void blit(K32_fixture* src, int srcStart, int count, int pixStart = 0) {
+      int skip;
+      if (!this->span(pixStart, count, skip)) return;
+      srcStart += skip;
+      if (srcStart < 0) { count += srcStart; pixStart -= srcStart; srcStart = 0; }
+      count = min(count, src->size() - srcStart);
+      if (count <= 0) return;
+
+      uint8_t m = this->_master;
+      auto master = [m](int i, pixelColor_t c) -> pixelColor_t { return CRGBW(c) % m; };
+
+      if (this->_frame) {
+        src->getBuffer(&this->_frame[pixStart], count, srcStart);
+        if (m < 255) spanScaleVideo(&this->_frame[pixStart], count, m);
+      }
+      else {
+        this->_strip->blit(src, srcStart, count, pixStart);
+        if (m < 255) this->_strip->map(pixStart, count, master);
+      }
     }
 
     // clear
@@ -342,79 +662,215 @@ class K32_anim {
     unsigned long startTime = 0;
     uint32_t frameCount = 0;
 
+    // DATA: int slots, override all to store data differently (see K32_anim_typed)
+    //
+
+    // store frame into data (dataLock taken), returns true if data changed
+    virtual bool write(const int* frame, int size) 
+    {
+      bool didChange = false;
+      size = min(size, ANIM_DATA_SLOTS);
+      for(int k=0; k<size; k++) 
+        if (this->_data[k] != frame[k]) {
+          this->_data[k] = frame[k]; 
+          didChange = true;
+        }
+      return didChange;
+    }
+
+    virtual bool write(const uint8_t* frame, int size) 
+    {
+      bool didChange = false;
+      size = min(size, ANIM_DATA_SLOTS);
+      for(int k=0; k<size; k++) 
+        if (this->_data[k] != frame[k]) {
+          this->_data[k] = frame[k]; 
+          didChange = true;
+        }
+      return didChange;
+    }
+
+    virtual void write(int k, int value) {
+      if (k >= 0 && k < ANIM_DATA_SLOTS) this->_data[k] = value;
+    }
+
+    // RENDER: copy data to frame data (dataLock taken), then modulate and draw it
+    virtual void latch() {
+      memcpy(this->_frameData, this->_data, ANIM_DATA_SLOTS*sizeof(int));
+    }
+
+    virtual bool modulateFrame(K32_modulator* m) {
+      return m->run(this->_frameData);
+    }
+
+    virtual void drawFrame() {
+      this->draw(this->_frameData);
+    }
+
 
   // PRIVATE
   //
   private:
 
+    // data received: wake up render task
+    K32_anim* changed(bool didChange) 
+    {
+      if (didChange || !this->_firstDataReceived) {
+        this->_newData = true;
+        renderWake();
+      }
+      return this;
+    }
+
     // input data
     int _data[ANIM_DATA_SLOTS];
 
-    // THREAD: draw frame on new data
-    static void animate( void * parameter ) 
-    {
-      K32_anim* that = (K32_anim*) parameter;
-      TickType_t timeout;
-
-      bool triggerDraw = false;
-      int dataCopy[ANIM_DATA_SLOTS];
+    // modulated data drawn by render()
+    int _frameData[ANIM_DATA_SLOTS];
 
-      that->startTime = millis();
-      that->frameCount = 0;
+    // MODULATOR removed (dataLock taken): render task only walks modulators under dataLock, it can be deleted now
+    void remove(int k) 
+    {
+      this->_modulators[k]->stop();
+      this->unlink(this->_modulators[k]);
+      delete this->_modulators[k];
+      this->_modulators[k] = NULL;
+    }
 
-      if (that->_firstDataReceived) xSemaphoreGive(that->newData);                  // Not first play -> data can be drawn now !
-      
-      that->init();                                                                 // Subclass init hook
+    // remove all links from / to modulator (dataLock taken)
+    void unlink(K32_modulator* modulator) 
+    {
+      int count = 0;
+      for (int l=0; l<this->_linkCount; l++)
+        if (this->_links[l].src != modulator && this->_links[l].dst != modulator) 
+          this->_links[count++] = this->_links[l];
+      this->_linkCount = count;
+      this->_graphDirty = true;
+    }
 
-      do 
-      {
-        that->frameCount++;
+    // MODULATION GRAPH: sort modulators so that each one runs after those modulating it (Kahn), 
+    // links to unregistered modulators are ignored. Returns false if links make a loop
+    bool compile(modGraph& g) 
+    {
+      int8_t src[ANIM_MOD_LINKS], dst[ANIM_MOD_LINKS];
+      uint8_t inputs[ANIM_MOD_SLOTS] = {0};
+      int mods = 0;
+
+      for (int l=0; l<this->_linkCount; l++) {
+        src[l] = dst[l] = -1;
+        for (int k=0; k<ANIM_MOD_SLOTS; k++) {
+          if (this->_modulators[k] == NULL) continue;
+          if (this->_modulators[k] == this->_links[l].src) src[l] = k;
+          if (this->_modulators[k] == this->_links[l].dst) dst[l] = k;
+        }
+        if (src[l] < 0 || dst[l] < 0) src[l] = dst[l] = -1;
+        else inputs[dst[l]] += 1;
+      }
 
-        xSemaphoreGive(that->bufferInUse);                                          // allow push & pushdata to modify data
-        yield();      
+      g.count = 0;
+      for (int k=0; k<ANIM_MOD_SLOTS; k++)
+        if (this->_modulators[k]) {
+          mods += 1;
+          if (inputs[k] == 0) g.order[g.count++] = k;
+        }
 
-        if (triggerDraw) timeout = pdMS_TO_TICKS( 1000/LIGHT_ANIMATE_FPS );          // adapt FPS if an image has been drawn (optimized strobe)
-        else timeout = pdMS_TO_TICKS( 500/LIGHT_ANIMATE_FPS );
+      int flows = 0;
+      for (int i=0; i<g.count; i++) {
+        g.flowStart[i] = flows;
+        for (int l=0; l<this->_linkCount; l++)
+          if (src[l] == g.order[i]) {
+            g.flow[flows++] = {(uint8_t)dst[l], this->_links[l].target};
+            if (--inputs[dst[l]] == 0) g.order[g.count++] = dst[l];
+          }
+      }
+      g.flowStart[g.count] = flows;
 
-        triggerDraw = (xSemaphoreTake(that->newData, timeout) == pdTRUE);
+      if (g.count < mods) {                         // loop: keep running all modulators, without graph
+        g.count = 0;
+        for (int k=0; k<ANIM_MOD_SLOTS; k++)
+          if (this->_modulators[k]) {
+            g.flowStart[g.count] = 0;
+            g.order[g.count++] = k;
+          }
+        g.flowStart[g.count] = 0;
+        return false;
+      }
+      return true;
+    }
 
+    // clip span to anim size and strip, pixStart is converted to strip position
+    // skip is the number of pixels cut at the beginning of the span
+    bool span(int& pixStart, int& count, int& skip) {
+      int first = pixStart;
+      if (pixStart < 0) { count += pixStart; pixStart = 0; }
+      count = min(count, this->_size - pixStart);
+      pixStart += this->_offset;
+      if (pixStart < 0) { count += pixStart; pixStart = 0; }
+      count = min(count, this->_strip->size() - pixStart);
+      skip = pixStart - this->_offset - first;
+      return count > 0;
+    }
 
-        xSemaphoreTake(that->bufferInUse, portMAX_DELAY);                           // lock buffer to prevent external change
+    // lock strip for drawing, buffered fixtures give direct access to their back frame
+    // layered anims draw in their layer, _frame is always indexed by strip position
+    void beginDraw() {
+      if (this->_layer) {
+        this->_frame = this->_layer - this->_layerStart;
+        return;
+      }
+      this->_strip->lock();
+      this->_frame = this->_strip->frame();
+    }
 
-        if (triggerDraw) that->_firstDataReceived = true;                           // Data has been set at least one time since anim creation
-        else if (!that->_firstDataReceived) continue;                               // Data has never been set -> we can't draw ! 
-        if (that->_stopAt && millis() >= that->_stopAt) break;                      // check if we should stop now
+    void endDraw() {
+      if (this->_layer) {
+        this->_frame = nullptr;
+        this->_layerChanged = true;
+        return;
+      }
+      if (this->_frame) this->_strip->touch(this->_offset, this->_size);
+      this->_frame = nullptr;
+      this->_strip->unlock();
+    }
 
-        memcpy(dataCopy, that->_data, ANIM_DATA_SLOTS*sizeof(int));                 // copy buffer
+    // apply spatial modulators on anim pixels (anim should redraw its whole span every frame)
+    void spread() 
+    {
+      uint8_t scale[FIXTURE_MAXPIXEL];
+      int pixStart = 0;
+      int count = min(this->_size, FIXTURE_MAXPIXEL);
+      int skip;
+      if (!this->span(pixStart, count, skip)) return;
 
-        xSemaphoreGive(that->bufferInUse);                                          // let data be push by others
-        
-        for (int k=0; k<ANIM_MOD_SLOTS; k++)
-          if (that->_modulators[k])       
-            triggerDraw = that->_modulators[k]->run(dataCopy) || triggerDraw;       // run modulators on data
-
-        
-        if (triggerDraw) {
-          that->_strip->lock();
-          that->draw(dataCopy);                                      // Subclass draw hook
-          that->_strip->unlock();
+      xSemaphoreTake(this->dataLock, portMAX_DELAY);                     // modulators can't be removed meanwhile
+      for (int k=0; k<ANIM_MOD_SLOTS; k++)
+        if (this->_modulators[k] && this->_modulators[k]->spatial()) 
+        {
+          this->_modulators[k]->spread(scale, skip, count);
+          if (this->_frame) spanScale(&this->_frame[pixStart], scale, count);
+          else this->_strip->map(pixStart, count, [&scale, pixStart](int i, pixelColor_t c) -> pixelColor_t { 
+            c.num = pixelScale(c.num, scale[i-pixStart]); 
+            return c; 
+          });
         }
+      xSemaphoreGive(this->dataLock);
+    }
 
-      } 
-      while(that->loop());
+    // stop and clear
+    void finish() 
+    {
+      this->_newData = false;
+      this->_paused = false;
+      this->_stage = 0;
 
-      
-      // stop and clear
-      xSemaphoreTake(that->newData, 1);
-      xSemaphoreGive(that->bufferInUse);
+      this->beginDraw();
+      this->clear();
+      this->endDraw();
 
-      that->clear();
-      that->animateHandle = NULL;
-  
-      xSemaphoreGive(that->wait_lock);
+      this->_state = ANIM_STOPPED;
+      xSemaphoreGive(this->wait_lock);
 
-      LOGF("ANIM: %s end \n", that->name().c_str());
-      vTaskDelete(NULL);
+      LOGF("ANIM: %s end \n", this->name().c_str());
     }
     
     // identity
@@ -423,22 +879,105 @@ class K32_anim {
 
     // output
     K32_fixture* _strip = NULL;
+    pixelColor_t* _frame = nullptr;
     uint8_t _master = 255;
     int _size = 0;
     int _offset = 0; 
 
+    // layer
+    pixelColor_t* _layer = nullptr;
+    int _layerStart = 0;
+    int _layerCount = 0;
+    blendMode _blendMode = BLEND_OVER;
+    uint8_t _opacity = 255;
+    std::atomic<bool> _layerChanged {false};
+
     // internal logic
-    SemaphoreHandle_t newData;  
-    SemaphoreHandle_t bufferInUse;  
+    std::atomic<bool> _newData {false};
+    SemaphoreHandle_t dataLock;  
     bool _firstDataReceived = false;
 
     // Animation
-    TaskHandle_t animateHandle = NULL;
+    std::atomic<uint8_t> _state {ANIM_STOPPED};
     SemaphoreHandle_t wait_lock;
     uint32_t _stopAt = 0;
+    bool _paused = false;
+    unsigned long _resumeAt = 0;
+    int _stage = 0;
 
-    // Modulator
+    // Modulator: slots written by users and walked by render task under dataLock
     K32_modulator* _modulators[ANIM_MOD_SLOTS];
+
+    // Modulation graph: links written by users under dataLock, compiled by render task
+    modLink _links[ANIM_MOD_LINKS];
+    int _linkCount = 0;
+    modGraph _graph;
+    std::atomic<bool> _graphDirty {true};
+};
+
+
+//
+// TYPED ANIM: data is a packed params struct T instead of int slots
+//
+//   struct colorParams { uint8_t r, g, b, w; } __attribute__((packed));
+//   class K32_anim_color : public K32_anim_typed<colorParams> { void draw(colorParams& p) {...} };
+//
+// push(uint8_t*) stores a DMX / ArtNet frame with a single memcmp + memcpy (byte k of frame is byte k of T),
+// push(int*) and set(k, v) write byte k. Modulators at(slot) scale the byte at that offset: 
+// fields to modulate should be uint8_t (at(offsetof(T, field)))
+//
+template<class T>
+class K32_anim_typed : public K32_anim {
+  static_assert(std::is_trivially_copyable<T>::value, "ANIM: params must be a plain struct");
+  static_assert(sizeof(T) <= ANIM_DATA_SLOTS, "ANIM: params must fit in ANIM_DATA_SLOTS bytes");
+
+  public:
+
+    // Loop: Defined in SubClass
+    virtual void draw(T& params) { LOG("ANIM: nothing to do.."); }
+
+  protected:
+
+    bool write(const uint8_t* frame, int size) 
+    {
+      size = min(size, (int)sizeof(T));
+      if (size <= 0 || memcmp(&this->_params, frame, size) == 0) return false;
+      memcpy(&this->_params, frame, size);
+      return true;
+    }
+
+    bool write(const int* frame, int size) 
+    {
+      bool didChange = false;
+      uint8_t* bytes = reinterpret_cast<uint8_t*>(&this->_params);
+      size = min(size, (int)sizeof(T));
+      for (int k=0; k<size; k++)
+        if (bytes[k] != (uint8_t)frame[k]) {
+          bytes[k] = frame[k];
+          didChange = true;
+        }
+      return didChange;
+    }
+
+    void write(int k, int value) {
+      if (k >= 0 && k < (int)sizeof(T)) reinterpret_cast<uint8_t*>(&this->_params)[k] = value;
+    }
+
+    void latch() {
+      this->_frameParams = this->_params;
+    }
+
+    bool modulateFrame(K32_modulator* m) {
+      return m->run(reinterpret_cast<uint8_t*>(&this->_frameParams), sizeof(T));
+    }
+
+    void drawFrame() {
+      this->draw(this->_frameParams);
+    }
+
+  private:
+    T _params = {};
+    T _frameParams = {};
 };
 
 
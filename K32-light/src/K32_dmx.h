@@ -10,11 +10,18 @@
 #include "_libfast/pixel.h"
 #include "esp_task_wdt.h"
 
+#define DMX_UNIVERSE 512
+#define DMX_FPS      40    // full universe refresh is ~44Hz (250kbps): default rate of DMX fixtures
+
 enum DmxDirection { DMX_IN, DMX_OUT };
 
 class K32_dmx {
   public:
     K32_dmx(const int DMX_PIN[3], DmxDirection dir) {
+
+      this->_lock = xSemaphoreCreateMutex();
+      memset(this->_universe, 0, sizeof(this->_universe));
+      memcpy(this->_pins, DMX_PIN, sizeof(this->_pins));
       
       // DIR pin
       if (DMX_PIN[0] > 0) {
@@ -48,27 +55,89 @@ class K32_dmx {
 
     };
 
-    // SET one value
-    K32_dmx* set(int index, int value) 
+    // Shared DMX output: ESP32DMX is one device per board, every fixture patches into its universe
+    // created with the pins of the first call, other pins are refused (nullptr, logged)
+    static K32_dmx* output(const int DMX_PIN[3]) 
     {
-      if (outputOK) {
-        xSemaphoreTake(ESP32DMX.lxDataLock, portMAX_DELAY);
-        ESP32DMX.setSlot(index, value);
-        xSemaphoreGive(ESP32DMX.lxDataLock);
+      static K32_dmx* shared = nullptr;
+      if (!shared) shared = new K32_dmx(DMX_PIN, DMX_OUT);
+      else if (memcmp(shared->_pins, DMX_PIN, sizeof(shared->_pins)) != 0) {
+        LOGF3("DMX: ERROR output already started on pins %d %d %d\n", shared->_pins[0], shared->_pins[1], shared->_pins[2]);
+        return nullptr;
       }
-      return this;
+      return shared;
+    }
+
+    // SET one value (pushed immediately)
+    K32_dmx* set(int index, int value) 
+    {
+      if (index < 1 || index > DMX_UNIVERSE) return this;
+      xSemaphoreTake(this->_lock, portMAX_DELAY);
+      this->_universe[index] = value;
+      this->markDirty(index, 1);
+      xSemaphoreGive(this->_lock);
+      return this->flush();
     }
 
-    // SET multiple values
+    // SET multiple values (pushed immediately)
     K32_dmx* setMultiple(int* values, int size, int offsetAdr = 1) 
     {
-      if (outputOK) {
       // LOGF3("DMX: setMultiple %d %d %d\n",values[0], size, offsetAdr);
-        xSemaphoreTake(ESP32DMX.lxDataLock, portMAX_DELAY);
-        for (int i = 0; i < size; i++)
-          ESP32DMX.setSlot(i+offsetAdr, values[i]);
-        xSemaphoreGive(ESP32DMX.lxDataLock);
+      if (!this->clip(offsetAdr, size)) return this;
+      xSemaphoreTake(this->_lock, portMAX_DELAY);
+      for (int i = 0; i < size; i++)
+        this->_universe[i+offsetAdr] = values[i];
+      this->markDirty(offsetAdr, size);
+      xSemaphoreGive(this->_lock);
+      return this->flush();
+    }
+
+    // PATCH values into universe, pushed by next flush()
+    K32_dmx* setMultiple(const uint8_t* values, int size, int offsetAdr = 1) 
+    {
+      int skip = max(0, 1-offsetAdr);
+      if (!this->clip(offsetAdr, size)) return this;
+      xSemaphoreTake(this->_lock, portMAX_DELAY);
+      memcpy(&this->_universe[offsetAdr], &values[skip], size);
+      this->markDirty(offsetAdr, size);
+      xSemaphoreGive(this->_lock);
+      return this;
+    }
+
+    // PATCH pixels into universe, channels per pixel: 3 (RGB) or 4 (RGBW), pushed by next flush()
+    K32_dmx* setPixels(const pixelColor_t* pixels, int count, int channels, int offsetAdr = 1) 
+    {
+      int start = offsetAdr;
+      int size = count * channels;
+      if (!this->clip(start, size)) return this;
+      xSemaphoreTake(this->_lock, portMAX_DELAY);
+      for (int i = 0; i < count; i++) {
+        const uint8_t slots[4] = {pixels[i].r, pixels[i].g, pixels[i].b, pixels[i].w};
+        for (int c = 0; c < channels; c++) {
+          int index = offsetAdr + i*channels + c;
+          if (index >= start && index < start + size) this->_universe[index] = slots[c];
+        }
+      }
+      this->markDirty(start, size);
+      xSemaphoreGive(this->_lock);
+      return this;
+    }
+
+    // PUSH modified slots to DMX output (one lock, one copy)
+    K32_dmx* flush() 
+    {
+      xSemaphoreTake(this->_lock, portMAX_DELAY);
+      if (this->_dirtyStop > this->_dirtyStart) 
+      {
+        if (outputOK) {
+          xSemaphoreTake(ESP32DMX.lxDataLock, portMAX_DELAY);
+          memcpy(&ESP32DMX.dmxData()[this->_dirtyStart], &this->_universe[this->_dirtyStart], this->_dirtyStop - this->_dirtyStart);
+          xSemaphoreGive(ESP32DMX.lxDataLock);
+        }
+        this->_dirtyStart = DMX_UNIVERSE+1;
+        this->_dirtyStop = 0;
       }
+      xSemaphoreGive(this->_lock);
       return this;
     }
 
@@ -76,6 +145,27 @@ class K32_dmx {
 
     bool outputOK = false;
     bool inputOK = false;
+    int _pins[3];
+
+    SemaphoreHandle_t _lock;
+    uint8_t _universe[DMX_UNIVERSE+1];    // slot 0 is start code
+    int _dirtyStart = DMX_UNIVERSE+1;     // dirty slots [start, stop[
+    int _dirtyStop = 0;
+
+    // clip to slots 1..DMX_UNIVERSE
+    bool clip(int& offsetAdr, int& size) {
+      if (offsetAdr < 1) {
+        size -= 1-offsetAdr;
+        offsetAdr = 1;
+      }
+      size = min(size, DMX_UNIVERSE+1 - offsetAdr);
+      return size > 0;
+    }
+
+    void markDirty(int offsetAdr, int size) {
+      this->_dirtyStart = min(this->_dirtyStart, offsetAdr);
+      this->_dirtyStop = max(this->_dirtyStop, offsetAdr + size);
+    }
 };
 
 #endif
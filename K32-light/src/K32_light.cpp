@@ -10,15 +10,27 @@
 K32_light::K32_light(K32* k32) : K32_plugin("leds", k32)
 {
   digitalLeds_init();
+  this->resetStats();
 
-  xTaskCreate( this->refresh,           // function
-                  "modulate_task",            // task name
-                  10000,                   // stack memory
+  xTaskCreatePinnedToCore( this->output,    // function
+                  "output_task",          // task name
+                  5000,                   // stack memory
                   (void*)this,            // args
                   4,                      // priority
-                  NULL );                 // handler
+                  &this->_outputHandle,   // handler
+                  0 );                    // core
+
+  xTaskCreatePinnedToCore( this->render,    // function
+                  "render_task",          // task name
+                  10000,                  // stack memory
+                  (void*)this,            // args
+                  3,                      // priority
+                  &renderTask(),          // handler (see renderWake)
+                  1 );                    // core
 
   pwm = new K32_pwm(k32);
+
+  this->routes();
 }
 
 K32_fixture* K32_light::addFixture(K32_fixture* fix)
@@ -29,6 +41,7 @@ K32_fixture* K32_light::addFixture(K32_fixture* fix)
   }
   this->_fixtures[this->_nfixtures] = fix;
   this->_nfixtures += 1;
+  this->compileRoutes();
 
   return fix;
 }
@@ -36,6 +49,7 @@ K32_fixture* K32_light::addFixture(K32_fixture* fix)
 // link every strip to masterStrip
 void K32_light::cloneFixturesFrom(K32_fixture* masterFixture) {
   this->_masterClone = masterFixture;
+  this->compileRoutes();
 }
 
 // link every strip to masterStrip
@@ -44,6 +58,7 @@ void K32_light::copyFixture(stripcopy copy) {
   {
     _copylist[_copyMax] = copy;
     _copyMax += 1;
+    this->compileRoutes();
   }
 }
 
@@ -55,9 +70,11 @@ K32_light* K32_light::fixtures() {
   return this;
 }
 
+// cleared fixtures are pushed by the render task (only one task outputs)
 K32_light* K32_light::black()
 {
-  for (int s = 0; s < this->_nfixtures; s++) this->_fixtures[s]->black();
+  for (int s = 0; s < this->_nfixtures; s++) this->_fixtures[s]->clear();
+  renderWake();
   return this;
 }
 
@@ -83,39 +100,133 @@ K32_light* K32_light::pix(int pixel, int red, int green, int blue, int white) {
 
 void K32_light::show() 
 {
-  // CLONE ALL from master strip (if _masterClone exist)
-  pixelColor_t* cloneBuffer = NULL;
-  int cloneSize = 0;
-  if (this->_masterClone && this->_masterClone->dirty()) {
-    cloneSize = this->_masterClone->size();
-    cloneBuffer = static_cast<pixelColor_t*>(malloc(cloneSize * sizeof(pixelColor_t)));
-    this->_masterClone->getBuffer(cloneBuffer, cloneSize);
-
-    if (cloneSize > 0)
-      for (int s=0; s<this->_nfixtures; s++)
-        this->_fixtures[s]->setBuffer(cloneBuffer, cloneSize); 
-    
-    free(cloneBuffer);
-  }
+  this->compose();
+  this->push();
+  this->flush();
+}
 
-  // COPY Fixtures
-  for (int c=0; c<_copyMax; c++) {
-    if (_copylist[c].srcFixture && _copylist[c].destFixture) 
-      if (_copylist[c].srcFixture->dirty())
-      {
-        pixelColor_t* copyBuffer = NULL;
-        int copySize = 0;
-        copySize = _copylist[c].srcStop-_copylist[c].srcStart+1;
-        copyBuffer = static_cast<pixelColor_t*>(malloc(copySize * sizeof(pixelColor_t)));
-        _copylist[c].srcFixture->getBuffer(copyBuffer, copySize, _copylist[c].srcStart);
-        _copylist[c].destFixture->setBuffer(copyBuffer, copySize, _copylist[c].destPos); 
-        free(copyBuffer);
-        _copylist[c].destFixture;
+// LAYERS: blend layered anims of each fixture (in registration order), when one of them changed
+void K32_light::blend() 
+{
+  for (int s=0; s<this->_nfixtures; s++) 
+  {
+    if (!this->_due[s]) continue;
+    K32_fixture* fix = this->_fixtures[s];
+    bool changed = false;
+    int start = fix->size();
+    int stop = 0;
+
+    for (int k=0; k<this->_animcounter; k++) 
+      if (this->_anims[k]->fixture() == fix && this->_anims[k]->layered()) {
+        changed = this->_anims[k]->layerChanged() || changed;
+        this->_anims[k]->layerSpan(start, stop);
       }
-  }  
 
-  for (int s=0; s<this->_nfixtures; s++)  this->_fixtures[s]->show();
+    if (!changed || stop <= start) continue;
+
+    memset(&this->_layerFrame[start], 0, (stop - start) * sizeof(pixelColor_t));
+    for (int k=0; k<this->_animcounter; k++) 
+      if (this->_anims[k]->fixture() == fix && this->_anims[k]->layered() && this->_anims[k]->isPlaying()) 
+        this->_anims[k]->layerBlend(this->_layerFrame);
+
+    if (fix->buffered()) {
+      fix->lock();
+      memcpy(&fix->frame()[start], &this->_layerFrame[start], (stop - start) * sizeof(pixelColor_t));
+      fix->touch(start, stop - start);
+      fix->unlock();
+    }
+    else fix->pix(start, stop - start, &this->_layerFrame[start]);
+  }
+}
+
+// CLONE / COPY: only dirty pixels are moved, straight from buffer to buffer
+void K32_light::compose() 
+{
+  for (int r=0; r<this->_routeCount; r++)
+    this->_routes[r].dest->route(this->_routes[r].src, this->_routes[r].srcStart, this->_routes[r].count, this->_routes[r].destPos);
+}
+
+// OUTPUT fixtures
+void K32_light::push() 
+{
+  if (!this->_sync) 
+    for (int s=0; s<this->_nfixtures; s++)  this->_fixtures[s]->show();
+
+  // SYNC: stage every strip, then push them together
+  else {
+    strand_t* strands[LIGHT_MAXFIXTURES];
+    K32_fixture* staged[LIGHT_MAXFIXTURES];
+    int count = 0;
+
+    for (int s=0; s<this->_nfixtures; s++) 
+    {
+      if (!this->_fixtures[s]->strand()) this->_fixtures[s]->show();
+      else if ((strands[count] = this->_fixtures[s]->stage())) staged[count++] = this->_fixtures[s];
+    }
+
+    if (count > 0) digitalLeds_drawPixels(strands, count);
+
+    for (int s=0; s<count; s++) staged[s]->release();
+  }
+}
+
+// FLUSH shared outputs (DMX universe): first fixture pushes, others have nothing left to do
+void K32_light::flush() 
+{
+  for (int s=0; s<this->_nfixtures; s++)  this->_fixtures[s]->flush();
+}
+
+void K32_light::sync(bool enable) {
+  this->_sync = enable;
+}
+
+void K32_light::pipeline(bool enable) {
+  this->_pipeline = enable;
+}
+
+lightStats K32_light::stats() {
+  return this->_stats;
+}
+
+void K32_light::resetStats() {
+  memset(&this->_stats, 0, sizeof(this->_stats));
+  this->_stats.degrade = this->_degrade;
+  this->_fpsStart = micros();
+  this->_fpsFrames = 0;
+  this->_overBudget = 0;
+  this->_peakLoad = 0;
+}
 
+static String stageStatus(const char* name, stageTiming& stage, uint32_t frames) {
+  return String(name) + "=" + String((uint32_t)(frames ? stage.total / frames : 0)) + "/" + String(stage.max) + " ";
+}
+
+String K32_light::status() 
+{
+  lightStats s = this->stats();
+
+  String status = "fps=" + String(s.fps) + " frames=" + String(s.frames) + " dropped=" + String(s.dropped) + " ";
+  status += "late=" + String(s.late) + " degrade=" + String(s.degrade) + " rates=";
+  for (int f=0; f<this->_nfixtures; f++) status += String(this->rate(f)) + ((f < this->_nfixtures-1) ? "," : "");
+  status += " ";
+  status += stageStatus("frame", s.frame, s.frames);
+  status += stageStatus("modulate", s.modulate, s.frames);
+  status += stageStatus("draw", s.draw, s.frames);
+  status += stageStatus("blend", s.blend, s.frames);
+  status += stageStatus("composite", s.composite, s.frames);
+  status += stageStatus("output", s.output, s.frames);
+  status += stageStatus("flush", s.flush, s.frames);
+
+  status += "hist=";
+  for (int b=0; b<LIGHT_HIST_BUCKETS; b++) status += String(s.frameHist[b]) + ((b < LIGHT_HIST_BUCKETS-1) ? "," : " ");
+
+#ifdef K32_HOST
+  status += "stack=n/a";      // host threads stacks are not watched
+#else
+  status += "stack=" + String(uxTaskGetStackHighWaterMark(renderTask()));
+  if (this->_outputHandle) status += "," + String(uxTaskGetStackHighWaterMark(this->_outputHandle));
+#endif
+  return status;
 }
 
 
@@ -172,152 +283,150 @@ void K32_light::fps(int f) {
   else _fps = LIGHT_SHOW_FPS;
 }
 
+void K32_light::adaptive(bool enable) {
+  this->_adaptive = enable;
+  if (!enable) this->_degrade = 0;
+}
 
-void K32_light::command(Orderz* order) 
-{
-  // ALL
-  if (strcmp(order->action, "all") == 0 || strcmp(order->action, "strip") == 0 || strcmp(order->action, "pixel") == 0)
-  {
-      int offset = 0;
-      if (strcmp(order->action, "strip") == 0) offset = 1;
-      if (strcmp(order->action, "pixel") == 0) offset = 2;
-
-      if (order->count() < offset+1) return;
-      int red, green, blue, white = 0;
-      
-      red = order->getData(offset+0)->toInt();
-      if (order->count() > offset+2) {
-          green = order->getData(offset+1)->toInt();
-          blue  = order->getData(offset+2)->toInt();
-          if (order->count() > offset+3) 
-              white = order->getData(offset+3)->toInt();
-      }
-      else { green = red; blue = red; white = red; }
-
-      this->blackout();
+int K32_light::rate(int s) {
+  if (s < 0 || s >= this->_nfixtures) return 0;
+  return max(1, this->_fps) / this->divider(s);
+}
 
-      if (strcmp(order->action, "all") == 0) 
-        this->all( red, green, blue, white );
-      else if (strcmp(order->action, "strip") == 0) 
-        this->fixture(order->getData(0)->toInt())->all( red, green, blue, white );
-      else if (strcmp(order->action, "pixel") == 0) 
-        this->fixture(order->getData(0)->toInt())->pix( order->getData(1)->toInt(), red, green, blue, white );
 
-      this->show();
-  }
+// register leds/ commands
+void K32_light::routes() 
+{
+  // ALL / STRIP / PIXEL
+  route("all",    [](K32_module* m, Orderz* o){ ((K32_light*)m)->colorCmd(o, 0); });
+  route("strip",  [](K32_module* m, Orderz* o){ ((K32_light*)m)->colorCmd(o, 1); });
+  route("pixel",  [](K32_module* m, Orderz* o){ ((K32_light*)m)->colorCmd(o, 2); });
 
   // MASTER
-  else if (strcmp(order->action, "master") == 0)
-  {
-      int masterValue = this->anim("manu")->master();
-
-      if (strcmp(order->subaction, "less") == 0)       masterValue -= 2;
-      else if (strcmp(order->subaction, "more") == 0)  masterValue += 2;
-      else if (strcmp(order->subaction, "full") == 0)  masterValue = 255;
-      else if (strcmp(order->subaction, "tenmore") == 0)  masterValue += 10;
-      else if (strcmp(order->subaction, "tenless") == 0)  masterValue -= 10;
-      else if (strcmp(order->subaction, "fadeout") == 0) {
-      if (!this->anim("manu")->hasmod("fadeout"))
-          this->anim("manu")->mod(new K32_mod_fadeout)->name("fadeout")->at(0)->period(6000)->play();
-      else
-          this->anim("manu")->mod("fadeout")->play();
-      }
-      else if (strcmp(order->subaction, "fadein") == 0) {
-      if (!this->anim("manu")->hasmod("fadein"))
-          this->anim("manu")->mod(new K32_mod_fadein)->name("fadein")->at(0)->period(6000)->play();
-      else
-          this->anim("manu")->mod("fadein")->play();
-      }
-      else if (order->count() > 0) masterValue = order->getData(0)->toInt();
-
-      this->anim("manu")->master( masterValue );
-      this->anim("manu")->push();
-  }
+  route("master",         [](K32_module* m, Orderz* o){ 
+    if (o->count() > 0) ((K32_light*)m)->masterCmd( o->getData(0)->toInt() ); 
+    else ((K32_light*)m)->masterCmd( ((K32_light*)m)->anim("manu")->master() );
+  });
+  route("master/less",    [](K32_module* m, Orderz* o){ ((K32_light*)m)->masterCmd( ((K32_light*)m)->anim("manu")->master() - 2 ); });
+  route("master/more",    [](K32_module* m, Orderz* o){ ((K32_light*)m)->masterCmd( ((K32_light*)m)->anim("manu")->master() + 2 ); });
+  route("master/full",    [](K32_module* m, Orderz* o){ ((K32_light*)m)->masterCmd( 255 ); });
+  route("master/tenmore", [](K32_module* m, Orderz* o){ ((K32_light*)m)->masterCmd( ((K32_light*)m)->anim("manu")->master() + 10 ); });
+  route("master/tenless", [](K32_module* m, Orderz* o){ ((K32_light*)m)->masterCmd( ((K32_light*)m)->anim("manu")->master() - 10 ); });
+  route("master/fadeout", [](K32_module* m, Orderz* o){
+    K32_anim* manu = ((K32_light*)m)->anim("manu");
+    if (!manu->hasmod("fadeout")) manu->mod(new K32_mod_fadeout)->name("fadeout")->at(0)->period(6000)->play();
+    else manu->mod("fadeout")->play();
+    ((K32_light*)m)->masterCmd( manu->master() );
+  });
+  route("master/fadein",  [](K32_module* m, Orderz* o){
+    K32_anim* manu = ((K32_light*)m)->anim("manu");
+    if (!manu->hasmod("fadein")) manu->mod(new K32_mod_fadein)->name("fadein")->at(0)->period(6000)->play();
+    else manu->mod("fadein")->play();
+    ((K32_light*)m)->masterCmd( manu->master() );
+  });
 
   // MEM (Manu)
-  else if (strcmp(order->action, "mem") == 0)
+  route("mem",    [](K32_module* m, Orderz* o)
   {
-      LOGF("LIGHT: leds/mem %i\n",  order->getData(0)->toInt());
+      LOGF("LIGHT: leds/mem %i\n",  o->getData(0)->toInt());
 
-      if (order->count() > 1) {
-        int masterValue = order->getData(1)->toInt();
-        this->anim("manu")->master( order->getData(1)->toInt() );
-      }
+      if (o->count() > 1) 
+        ((K32_light*)m)->anim("manu")->master( o->getData(1)->toInt() );
 
       // reset order
-      if (order->count() > 0) {
-        int mem = order->getData(0)->toInt();
-        order->set("remote/macro")->addData(mem);
+      if (o->count() > 0) {
+        int mem = o->getData(0)->toInt();
+        o->set("remote/macro")->addData(mem);
       }
-
-  }
+  });
 
   // FRAME
-  else if (strcmp(order->action, "frame") == 0)
+  route("frame",  [](K32_module* m, Orderz* o)
   {
       LOG("DISPATCH: leds/frame");
 
-      for(int k=0; k<order->count(); k++) {
-        int v = order->getData(k)->toInt(); 
-        if (v >= 0) this->anim("manu")->set(k, v);
+      K32_anim* manu = ((K32_light*)m)->anim("manu");
+      for(int k=0; k<o->count(); k++) {
+        int v = o->getData(k)->toInt(); 
+        if (v >= 0) manu->set(k, v);
       }
-      this->anim("manu")->push();
-  }
+      manu->push();
+  });
+
+  // STOP (reset order)
+  route("stop",     [](K32_module* m, Orderz* o){ o->set("remote/stop"); });
+  route("off",      [](K32_module* m, Orderz* o){ o->set("remote/stop"); });
+  route("blackout", [](K32_module* m, Orderz* o){ o->set("remote/stop"); });
+
+  // MODULATORS (Manu): select mod by name, by index or all 
+  route("mod",    [](K32_module* m, Orderz* o){ 
+    if (o->count() < 1) return;
+    int i = ((K32_light*)m)->anim("manu")->modindex( String(o->getData(0)->toStr()) );
+    ((K32_light*)m)->modCmd(o, i, i+1);
+  });
+  route("modi",   [](K32_module* m, Orderz* o){ 
+    if (o->count() < 1) return;
+    int i = o->getData(0)->toInt();
+    ((K32_light*)m)->modCmd(o, i, i+1);
+  });
+  route("modall", [](K32_module* m, Orderz* o){ ((K32_light*)m)->modCmd(o, 0, ANIM_MOD_SLOTS); });
+
+  // PROFILE (see status)
+  route("stats/reset", [](K32_module* m, Orderz* o){ ((K32_light*)m)->resetStats(); });
+}
 
-  // STOP
-  else if (strcmp(order->action, "stop") == 0 || strcmp(order->action, "off") == 0 || strcmp(order->action, "blackout") == 0)
-  {
-      // reset order
-      order->set("remote/stop");
+// leds/all, leds/strip, leds/pixel: color arguments start at offset
+void K32_light::colorCmd(Orderz* order, int offset) 
+{
+  if (order->count() < offset+1) return;
+  int red, green, blue, white = 0;
+  
+  red = order->getData(offset+0)->toInt();
+  if (order->count() > offset+2) {
+      green = order->getData(offset+1)->toInt();
+      blue  = order->getData(offset+2)->toInt();
+      if (order->count() > offset+3) 
+          white = order->getData(offset+3)->toInt();
   }
+  else { green = red; blue = red; white = red; }
 
-  // MODULATORS (Manu)
-  else if (strcmp(order->action, "mod") == 0 || strcmp(order->action, "modi") == 0 || strcmp(order->action, "modall") == 0) 
-  { 
-      int startmod = -1;
-      int stopmod = -1;
-
-      // select mod by name
-      if (strcmp(order->action, "mod") == 0 && order->count() >= 1) {
-        startmod = this->anim("manu")->modindex( String(order->getData(0)->toStr()) );
-        stopmod = startmod+1;
-      }
-
-      // select mod by index
-      else if (strcmp(order->action, "modi") == 0  && order->count() >= 1)  {
-        startmod = order->getData(0)->toInt();
-        stopmod = startmod+1;
-      }
-
-      // select all mod 
-      else if (strcmp(order->action, "modall") == 0) {
-        startmod = 0;
-        stopmod = ANIM_MOD_SLOTS;
-      }
+  this->blackout();
 
-      // no mod found selected: exit
-      if (startmod < 0) return;
+  if (offset == 0) 
+    this->all( red, green, blue, white );
+  else if (offset == 1) 
+    this->fixture(order->getData(0)->toInt())->all( red, green, blue, white );
+  else if (offset == 2) 
+    this->fixture(order->getData(0)->toInt())->pix( order->getData(1)->toInt(), red, green, blue, white );
 
-      // apply to mod selection
-      for(int k=startmod; k<stopmod; k++) {
-        if (!this->anim("manu")->hasmod(k)) 
-          continue;
-        
-        if (strcmp(order->subaction, "faster") == 0) 
-          this->anim("manu")->mod(k)->faster();
+  renderWake();     // pushed by the render task, never from the dispatcher
+}
 
-        else if (strcmp(order->subaction, "slower") == 0) 
-          this->anim("manu")->mod(k)->slower();
+// leds/master
+void K32_light::masterCmd(int masterValue) 
+{
+  this->anim("manu")->master( masterValue );
+  this->anim("manu")->push();
+}
 
-        else if (strcmp(order->subaction, "bigger") == 0) 
-          this->anim("manu")->mod(k)->bigger();
+// leds/mod*/subaction applied to mods [start, stop[
+void K32_light::modCmd(Orderz* order, int start, int stop) 
+{
+  // no mod found selected: exit
+  if (start < 0) return;
 
-        else if (strcmp(order->subaction, "smaller") == 0) 
-          this->anim("manu")->mod(k)->smaller();
-      }
+  K32_anim* manu = this->anim("manu");
+  for(int k=start; k<stop; k++) {
+    if (!manu->hasmod(k)) 
+      continue;
+    
+    if (strcmp(order->subaction, "faster") == 0)        manu->mod(k)->faster();
+    else if (strcmp(order->subaction, "slower") == 0)   manu->mod(k)->slower();
+    else if (strcmp(order->subaction, "bigger") == 0)   manu->mod(k)->bigger();
+    else if (strcmp(order->subaction, "smaller") == 0)  manu->mod(k)->smaller();
+    else if (strcmp(order->subaction, "wavelength") == 0 && order->count() > 0) 
+      manu->mod(k)->wavelength( order->getData(order->count()-1)->toInt() );
   }
-
-  return;
 }
 
 /*
@@ -327,14 +436,192 @@ void K32_light::command(Orderz* order)
 
 int K32_light::_nfixtures = 0;
 
-// thread function
-void K32_light::refresh( void * parameter ) 
+// flatten clone and copy lists into the route table used by show()
+void K32_light::compileRoutes() 
+{
+  int count = 0;
+
+  // CLONE ALL from master strip (if _masterClone exist)
+  if (this->_masterClone)
+    for (int s=0; s<this->_nfixtures; s++)
+      if (this->_fixtures[s] != this->_masterClone) 
+        this->_routes[count++] = { this->_masterClone, 0, this->_masterClone->size(), this->_fixtures[s], 0 };
+
+  // COPY Fixtures
+  for (int c=0; c<this->_copyMax; c++)
+    if (this->_copylist[c].srcFixture && this->_copylist[c].destFixture)
+      this->_routes[count++] = { this->_copylist[c].srcFixture, this->_copylist[c].srcStart, 
+                                  this->_copylist[c].srcStop - this->_copylist[c].srcStart + 1, 
+                                  this->_copylist[c].destFixture, this->_copylist[c].destPos };
+
+  this->_routeCount = count;
+}
+
+// elapsed time since t, t is moved to now
+static uint32_t lap(stageTiming& stage, uint32_t& t) 
+{
+  uint32_t now = micros();
+  stage.last = now - t;
+  stage.total += stage.last;
+  if (stage.last > stage.max) stage.max = stage.last;
+  t = now;
+  return stage.last;
+}
+
+// composite + output, timed
+void K32_light::present() 
+{
+  uint32_t t = micros();
+  this->compose();
+  lap(this->_stats.composite, t);
+  this->push();
+  lap(this->_stats.output, t);
+  this->flush();
+  lap(this->_stats.flush, t);
+}
+
+// RATES: fixture s is drawn every divider(s) frames (own rate, never exceeded, and budget degrade)
+int K32_light::divider(int s) 
+{
+  int fps = max(1, this->_fps);
+  int rate = this->_fixtures[s]->rate();
+  int div = (rate > 0 && rate < fps) ? (fps + rate - 1) / rate : 1;
+  return div << this->_degrade;
+}
+
+// anim is modulated and drawn when its fixture is due
+bool K32_light::due(K32_anim* anim) 
+{
+  for (int s=0; s<this->_nfixtures; s++)
+    if (this->_fixtures[s] == anim->fixture()) return this->_due[s];
+  return true;
+}
+
+// BUDGET: called once per second by render with frames count of the window
+void K32_light::adapt(uint32_t frames) 
+{
+  uint32_t budget = 1000000 / max(1, this->_fps);
+  uint8_t level = this->_degrade;
+
+  if (this->_overBudget > frames/10) level = min(LIGHT_DEGRADE_MAX, level+1);
+  else if (this->_overBudget == 0 && this->_peakLoad < budget/2 && level > 0) level -= 1;
+
+  if (level != this->_degrade) LOGF2("LIGHT: frame budget %dus, degrade level %d\n", (int)budget, (int)level);
+  this->_degrade = level;
+  this->_stats.degrade = level;
+  this->_overBudget = 0;
+  this->_peakLoad = 0;
+}
+
+// frame time histogram bucket: <1ms, then one bucket per power of 2 ms
+static int histBucket(uint32_t us) {
+  uint32_t ms = us / 1000;
+  if (ms == 0) return 0;
+  return min(LIGHT_HIST_BUCKETS-1, 32 - __builtin_clz(ms));
+}
+
+// thread function: master frame clock, every stage runs once per tick, in order
+void K32_light::render( void * parameter ) 
+{
+  K32_light* that = (K32_light*) parameter;
+  bool doDraw[LIGHT_ANIMS_SLOTS];
+  TickType_t lastWake = xTaskGetTickCount();
+  uint32_t pacing = 0;
+
+  while(true) 
+  {
+    // PACING: absolute deadlines, ticks remainder carried to next frames (60fps on 1ms tick: 17, 17, 16 ...)
+    int fps = max(1, that->_fps);
+    pacing += configTICK_RATE_HZ;
+    TickType_t period = max((uint32_t)1, pacing / fps);
+    pacing -= min(pacing, period * fps);
+
+    // LATE: deadline already passed, start now and resync (vTaskDelayUntil would burst to catch up)
+    if (xTaskGetTickCount() - lastWake > period) {
+      lastWake = xTaskGetTickCount() - period;
+      that->_stats.late += 1;
+    }
+    vTaskDelayUntil( &lastWake, period );
+
+    // SHOW CLOCK: frames start on show time boundaries, synced nodes draw the same frames (1 tick nudge per frame)
+    if (showClock().synced()) {
+      uint32_t into = ((uint64_t)showClock().now() * fps % 1000) / fps;     // ms since frame boundary
+      if (into > 1 && into < period/2) lastWake -= 1;
+      else if (into >= period/2 && into+1 < period) lastWake += 1;
+    }
+
+    uint32_t t = micros();
+    uint32_t start = t;
+    int count = that->_animcounter;
+    uint32_t dropped = that->_stats.dropped;
+
+    // RATES: fixtures drawn on this frame (staggered, see divider)
+    for (int s=0; s<that->_nfixtures; s++) 
+      that->_due[s] = ((that->_stats.frames + s) % that->divider(s)) == 0;
+
+    // MODULATE
+    for (int k=0; k<count; k++) doDraw[k] = that->due(that->_anims[k]) && that->_anims[k]->modulate();
+    lap(that->_stats.modulate, t);
+
+    // DRAW
+    for (int k=0; k<count; k++) 
+      if (doDraw[k]) that->_anims[k]->render();
+    lap(that->_stats.draw, t);
+
+    // BLEND layers
+    that->blend();
+    lap(that->_stats.blend, t);
+
+    // COMPOSITE → OUTPUT: right now, or on output task while next frame is drawn
+    bool awake = false;
+    if (!that->_pipeline) that->present();
+    else if (that->_outputBusy.exchange(true)) {
+      that->_stats.dropped += 1;
+      awake = true;                                                     // dropped frame must be sent next tick
+    }
+    else xTaskNotifyGive(that->_outputHandle);
+
+    that->_stats.frames += 1;
+
+    // PROFILE: frame time, achieved fps
+    uint32_t load = lap(that->_stats.frame, start);
+    that->_stats.frameHist[ histBucket(load) ] += 1;
+    if (load > (uint32_t)(1000000/fps) || that->_stats.dropped != dropped) that->_overBudget += 1;
+    that->_peakLoad = max(that->_peakLoad, load);
+
+    if (start - that->_fpsStart >= 1000000) {
+      uint32_t frames = that->_stats.frames - that->_fpsFrames;
+      that->_stats.fps = ((uint64_t)frames * 1000000) / (start - that->_fpsStart);
+      that->_fpsStart = start;
+      that->_fpsFrames = that->_stats.frames;
+      if (that->_adaptive) that->adapt(frames);
+    }
+
+    // SLEEP: no anim needs the clock, wait for a change (data, play, modulator, fixture write: see renderWake)
+    for (int k=0; k<count && !awake; k++) awake = that->_anims[k]->awake();
+    if (!awake) {
+      that->_stats.fps = 0;
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      lastWake = xTaskGetTickCount();
+      that->_fpsStart = micros();
+      that->_fpsFrames = that->_stats.frames;
+      that->_overBudget = 0;
+      that->_peakLoad = 0;
+    }
+  }
+  
+  vTaskDelete(NULL);
+}
+
+// thread function: composite and output frame handed over by render (pipeline)
+void K32_light::output( void * parameter ) 
 {
   K32_light* that = (K32_light*) parameter;
   while(true) 
   {
-    vTaskDelay( pdMS_TO_TICKS( 1000/that->_fps ) );
-    that->show();
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    that->present();
+    that->_outputBusy = false;
   }
   
   vTaskDelete(NULL);
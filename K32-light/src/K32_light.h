@@ -7,10 +7,11 @@
 #define K32_light_h
 
 #define LIGHT_MAXFIXTURES   8     // There is 8 RMT channels on ESP32 for leds strips
-#define LIGHT_ANIMATE_FPS  100     // Anims modulation FPS
-#define LIGHT_SHOW_FPS     100     // Show RMT push FPS
+#define LIGHT_SHOW_FPS     100     // Master frame clock: modulate, draw, composite and output FPS
 #define LIGHT_ANIMS_SLOTS  16      
 #define LIGHT_MAX_COPY     16
+#define LIGHT_HIST_BUCKETS  8      // frame time histogram: <1ms, <2ms, <4ms ... >=64ms
+#define LIGHT_DEGRADE_MAX   3      // frame budget overrun: fixtures rates divided by up to 2^3
 
 
 #include <class/K32_plugin.h>
@@ -31,6 +32,31 @@
 #include "animations/K32_anim_basics.h"
 #include "animations/K32_anim_charge.h"
 
+// Time spent in one pipeline stage (microseconds)
+struct stageTiming
+{
+  uint32_t last;
+  uint32_t max;
+  uint64_t total;
+};
+
+struct lightStats
+{
+  uint32_t frames;          // frame clock ticks
+  uint32_t dropped;         // frames not composited / output because output was still busy (pipeline)
+  uint32_t fps;             // frames per second achieved over the last second (0: clock sleeping)
+  uint32_t late;            // frames started after their deadline (clock resynced, no catch up burst)
+  uint8_t degrade;          // frame budget level: fixtures rates are divided by 2^degrade
+  stageTiming frame;        // render task work for one frame (whole pipeline when not pipelined)
+  uint32_t frameHist[LIGHT_HIST_BUCKETS];
+  stageTiming modulate;     // anims modulate()
+  stageTiming draw;         // anims draw()
+  stageTiming blend;        // anims layers blended on fixtures
+  stageTiming composite;    // clone / copy routes
+  stageTiming output;       // fixtures show() / sync push (RMT pack)
+  stageTiming flush;        // shared outputs flush() (DMX write)
+};
+
 struct stripcopy
 {
   K32_fixture* srcFixture;
@@ -40,6 +66,16 @@ struct stripcopy
   int destPos;
 };
 
+// precompiled clone / copy, run by show() without allocation
+struct striproute
+{
+  K32_fixture* src;
+  int srcStart;
+  int count;
+  K32_fixture* dest;
+  int destPos;
+};
+
 
 
 class K32_light : K32_plugin {
@@ -65,6 +101,20 @@ class K32_light : K32_plugin {
     void show();
     void blackout();
 
+    // Push all RMT strips together (load all channels, then start them at once)
+    void sync(bool enable = true);
+
+    // Composite and output frame N on core 0 while frame N+1 is drawn on core 1 
+    // (fixtures should be buffered, see K32_fixture::buffered)
+    void pipeline(bool enable = true);
+
+    // Per-stage timing since start (or last resetStats)
+    lightStats stats();
+    void resetStats();
+
+    // Profile summary for network status: fps, stages avg/max (us), frame histogram, stacks high water mark
+    String status();
+
 
     //  ANIM
     //
@@ -72,14 +122,25 @@ class K32_light : K32_plugin {
     K32_anim* anim( K32_fixture* fix, String animName, K32_anim* anim, int size = 0, int offset = 0);
     void stop();
 
-    // Set FPS
+    // Set FPS (master frame clock, fixtures can run slower: see K32_fixture::rate)
     void fps(int f = -1);
-    
-    void command(Orderz* order);
+
+    // Frame budget: when frames overrun 1/fps, halve fixtures rates (one level per second, see LIGHT_DEGRADE_MAX), 
+    // restore them when load drops below half the budget
+    void adaptive(bool enable = true);
+
+    // Actual output rate of fixture s (frames per second)
+    int rate(int s);
 
     K32_pwm* pwm = nullptr;
 
   private:
+
+    // COMMANDS
+    void routes();
+    void colorCmd(Orderz* order, int offset);
+    void masterCmd(int masterValue);
+    void modCmd(Orderz* order, int start, int stop);
     
     static int _nfixtures;
     K32_fixture* _fixtures[LIGHT_MAXFIXTURES];
@@ -88,13 +149,41 @@ class K32_light : K32_plugin {
     int _animcounter = 0;
 
     
-    static void refresh( void * parameter ) ;
+    // PIPELINE: modulate → draw → composite → output, once per frame clock tick
+    static void render( void * parameter ) ;
+    static void output( void * parameter ) ;
+    void blend();
+    void compose();
+    void push();
+    void flush();
+    void present();
+    int divider(int s);
+    bool due(K32_anim* anim);
+    void adapt(uint32_t frames);
+    TaskHandle_t _outputHandle = NULL;
+    std::atomic<bool> _outputBusy {false};
+    bool _pipeline = false;
+    lightStats _stats;
+    uint32_t _fpsStart = 0;       // fps window: start (us) and frame count at start
+    uint32_t _fpsFrames = 0;
+    uint32_t _overBudget = 0;     // frames over budget in fps window, and worst one (us)
+    uint32_t _peakLoad = 0;
+    bool _adaptive = true;
+    uint8_t _degrade = 0;
+    bool _due[LIGHT_MAXFIXTURES];   // fixtures drawn on this frame
+    pixelColor_t _layerFrame[FIXTURE_MAXPIXEL];    // layers are blended here, then copied to fixture
+
     int _fps = LIGHT_SHOW_FPS;
+    bool _sync = false;
 
     K32_fixture* _masterClone = nullptr;
 
     int _copyMax = 0;
     stripcopy _copylist[LIGHT_MAX_COPY];
+
+    void compileRoutes();
+    int _routeCount = 0;
+    striproute _routes[LIGHT_MAXFIXTURES+LIGHT_MAX_COPY];
 };
 
 
@@ -16,25 +16,49 @@ Modulators needs to define at least the method   int value()
 This method returns a (int) value generated by the modulator based on internal parameters.
 Warning: this value will be CLAMPED to 0->255 by modulator run() function
 
-The common parameters (available for all modulators):
+The common parameters (available for all modulators), as seen by the render task:
 
-  int period()                    = period length  (default = 1000)
-  int phase()                     = phase value    (default = 0)
-  int maxi()                      = maximum value  (default = 255)
-  int mini()                      = minimum value  (default = 0)
-  int amplitude()                 = maxi-mini     
+  int livePeriod()                = period length  (default = 1000)
+  int livePhase()                 = phase value    (default = 0)
+  int liveMaxi()                  = maximum value  (default = 255)
+  int liveMini()                  = minimum value  (default = 0)
+  int liveAmplitude()             = maxi-mini     
 
-  uint32_t time()                 = current time if modulator is playing or freezeTime if mod is paused. 
+  int time()                      = current show time (see K32_clock) if modulator is playing or freezeTime if mod is paused. 
+                                      signed: negative before trigger / phase delay (fadein, fadeout... test time() < 0)
                                       if using K32_modulator_periodic: time is corrected with phase (1/360 of period)
                                       if using K32_modulator_trigger: time is based on play() time and corrected with phase as fixed delay (ms)
                                       
+  int position()                  = time() % livePeriod(), in ms
+  uint16_t progress16()           = progress in period between 0 and 65535 (fixed point, prefer this one)
   float progress()                = % of progress in period between 0.0 and 1.0 
   int periodCount()               = count the number of period iteration since time()
 
+Fixed point waveforms (see _libfast/wave16.h) take progress16() and give a level between 0 and 65535:
 
-Modulator can also access / modify those generic parameters:
+  sine16(), triangle16(), sawtooth16()
+  int scale16level(level, range)  = level scaled to 0 -> range
+
+SPATIAL modulators: periodic modulators defining   uint16_t shape(uint16_t phase)   (waveform level 0 -> 65535 for a phase 0 -> 65535)
+can also be spread along the anim pixels with wavelength(pixels): instead of scaling data slots, each pixel is scaled by 
+the modulator value, phase shifted by one period every wavelength pixels (the wave travels toward the end of the strip).
+
+  int level(uint16_t phase)       = shape(phase) scaled to liveMini() -> liveMaxi()
+
+
+Modulator can also read those generic parameters:
 
   int params[MOD_PARAMS_SLOTS]    = modulator generic parameters, set by external users, can be renamed for convenience using local int& attribute
+                                    READ ONLY in value(): writes are overwritten by the next load(), use param() to change them
+
+Params are set by users with param(), period(), phase(), mini(), maxi()... and read back with period(), phase(), mini(), maxi()...
+(last value set). Inside value() they are a snapshot (live*() and params), refreshed lock-free before each run(): 
+several setters wrapped in edit() / commit() are seen together.
+
+MODULATION GRAPH: the output of a modulator can also scale a param of another modulator of the same anim, every frame
+(255 = unchanged, like data slots). Modulators run in dependency order, loops are refused.
+
+  anim->patch(src, dst, MOD_PERIOD)   targets: MOD_PERIOD, MOD_WAVELENGTH, MOD_PHASE, MOD_MINI, MOD_MAXI, MOD_PARAM+k
 
 */
 
@@ -50,9 +74,14 @@ Modulator can also access / modify those generic parameters:
 class K32_mod_sinus : public K32_modulator_periodic {
   public:  
     
+    uint16_t shape(uint16_t phase) 
+    {
+      return sine16(phase);
+    };
+
     int value()
     {
-      return (0.5f + 0.5f * sin(2 * PI * progress())) * amplitude() + mini();
+      return level(progress16());
     };
   
 };
@@ -63,13 +92,14 @@ class K32_mod_sinus : public K32_modulator_periodic {
 class K32_mod_triangle : public K32_modulator_periodic {
   public:  
 
+    uint16_t shape(uint16_t phase) 
+    {
+      return triangle16(phase);
+    };
+
     int value()
     { 
-      float percent = progress();
-      if (percent > 0.5) percent = 1 - percent;
-
-      // LOGF5("tri %d %d %d %d %d\n", mini(), maxi(), percent, time(), period());
-      return 2*percent * amplitude() + mini();
+      return level(progress16());
     };
   
 };
@@ -80,9 +110,14 @@ class K32_mod_triangle : public K32_modulator_periodic {
 class K32_mod_sawtooth : public K32_modulator_periodic {
   public:  
 
+    uint16_t shape(uint16_t phase) 
+    {
+      return sawtooth16(phase);
+    };
+
     int value()
     {
-      return progress() * amplitude() + mini();
+      return level(progress16());
     };
   
 };
@@ -93,9 +128,14 @@ class K32_mod_sawtooth : public K32_modulator_periodic {
 class K32_mod_isawtooth : public K32_modulator_periodic {
   public:  
 
+    uint16_t shape(uint16_t phase) 
+    {
+      return 65535 - sawtooth16(phase);
+    };
+
     int value()
     {
-      return maxi() - progress() * amplitude();
+      return level(progress16());
     };
 
 };
@@ -110,12 +150,19 @@ class K32_mod_pulse : public K32_modulator_periodic {
     int& widthMS  = params[0];  // pulse ON width in milliseconds
     int& widthPCT = params[1];  // pulse ON width in percentage (activated if widthMS = 0)
 
+    uint16_t shape(uint16_t phase) 
+    {
+      int width = widthMS;
+      if (widthMS == 0) width = livePeriod()*widthPCT/100;
+      return (phase < (uint32_t)width * 65536 / livePeriod()) ? 65535 : 0;
+    };
+
     int value()
     {  
       int width = widthMS;
-      if (widthMS == 0) width = period()*widthPCT/100;
-      if ( time() % period() < width) return maxi();
-      else return mini();
+      if (widthMS == 0) width = livePeriod()*widthPCT/100;
+      if ( position() < width) return liveMaxi();
+      else return liveMini();
     };
 
 };
@@ -130,12 +177,19 @@ class K32_mod_multipulse : public K32_modulator_periodic {
     int& widthMS  = params[0];  // pulse ON width in milliseconds
     int& widthPCT = params[1];  // pulse ON width in percentage (activated if widthMS = 0)
 
+    uint16_t shape(uint16_t phase) 
+    {
+      int width = widthMS;
+      if (widthMS == 0) width = livePeriod()*widthPCT/100;
+      return (phase < (uint32_t)width * 65536 / livePeriod()) ? 65535 : 0;
+    };
+
     int value()
     {  
       int width = widthMS;
-      if (widthMS == 0) width = period()*widthPCT/100;
-      if ( time() % period() < width) return maxi();
-      else return mini();
+      if (widthMS == 0) width = livePeriod()*widthPCT/100;
+      if ( position() < width) return liveMaxi();
+      else return liveMini();
     };
 
 };
@@ -156,7 +210,7 @@ class K32_mod_random : public K32_modulator_periodic {
       int newPeriod = periodCount();
       if (newPeriod != lastPeriod) {
         lastPeriod = newPeriod;
-        lastValue = random(mini(), maxi());
+        lastValue = random(liveMini(), liveMaxi());
       }
       return lastValue;
     };
@@ -180,13 +234,13 @@ class K32_mod_fadein : public K32_modulator_trigger {
       if (time() < 0) return 255; 
 
       // end of modulation
-      if (time() >= period()) 
+      if (time() >= livePeriod()) 
       {
         stop();
-        return maxi();
+        return liveMaxi();
       }
       
-      return progress() * amplitude() + mini();
+      return scale16level(progress16(), liveAmplitude()) + liveMini();
 
     };
 };
@@ -203,13 +257,13 @@ class K32_mod_fadeout : public K32_modulator_trigger {
       if (time() < 0) return 255; 
 
       // end of modulation
-      if (time() >= period()) 
+      if (time() >= livePeriod()) 
       {
         stop();
-        return mini();
+        return liveMini();
       }
       
-      return maxi() - progress() * amplitude();
+      return scale16level(65535 - progress16(), liveAmplitude()) + liveMini();
       
     };
 };
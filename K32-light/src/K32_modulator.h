@@ -9,6 +9,8 @@
 #define MOD_PARAMS_SLOTS 8
 
 #include "K32_anim.h"
+#include "_libfast/wave16.h"
+#include <utils/K32_clock.h>
 
 /*
   NOTE: This is the modulator BASE class,
@@ -16,6 +18,30 @@
 */
 
 
+//
+// PARAMS BLOCK: edited by users (setup, OSC, MQTT...), published as a whole to the render task
+//
+struct modParams {
+  int period = 1000;
+  int wavelength = 0;
+  int phase = 0;
+  int mini = 0;
+  int maxi = 255;
+  int params[MOD_PARAMS_SLOTS] = {};
+};
+
+// MODULATION GRAPH: params of a modulator that can be modulated by another modulator output (see K32_anim::patch)
+enum modTarget : uint8_t {
+  MOD_PERIOD,
+  MOD_WAVELENGTH,
+  MOD_PHASE,
+  MOD_MINI,
+  MOD_MAXI,
+  MOD_PARAM         // MOD_PARAM + k: params[k]
+};
+#define MOD_TARGETS   (MOD_PARAM + MOD_PARAMS_SLOTS)
+
+
 //
 // BASE MODULATOR
 //
@@ -23,17 +49,16 @@ class K32_modulator
 {
 public:
   K32_modulator() {
-    this->paramInUse = xSemaphoreCreateBinary();
-    xSemaphoreGive(this->paramInUse);
+    this->editLock = xSemaphoreCreateRecursiveMutex();
 
-    memset(this->params, 0, sizeof this->params);
+    memset(this->_depth, 255, sizeof this->_depth);
 
     for (int s=0; s<ANIM_DATA_SLOTS; s++) 
       this->dataslot[s] = false;
   }
 
   virtual ~K32_modulator() {
-    vQueueDelete(this->paramInUse);
+    vSemaphoreDelete(this->editLock);
   }
 
   // get/set name
@@ -62,14 +87,15 @@ public:
 
   K32_modulator* trigger() 
   {
-    this->triggerTime = millis();
+    this->triggerTime = showClock().now();
     this->_fresh = true;
+    renderWake();
     return this;
   }
 
   K32_modulator* pause()
   {
-    this->freezeTime = millis();
+    this->freezeTime = showClock().now();
     return this;
   }
 
@@ -79,82 +105,154 @@ public:
     return this;
   }
 
-  // Execute modulation function
+  bool running() { return this->isRunning; }
+
+  // Execute modulation function on int data slots
   bool run(int *animData)
   { 
-    bool didChange = false;
+    int val;
+    bool didChange = this->step(val);
 
-    if (this->isRunning)
-    {
-      // Get Modulator value
-      xSemaphoreTake(this->paramInUse, portMAX_DELAY);
-      int val = this->value();
-      xSemaphoreGive(this->paramInUse);
-
-      // CLAMP modulator value to 0->255
-      val = min(255, val);
-      val = max(0, val);
-
-      // Apply modulation to dataslots, value of 255 will not do anything
-      if (val < 255) {
-        for (int s=0; s<ANIM_DATA_SLOTS; s++)
-          if (this->dataslot[s]) animData[s] = scale16by8(animData[s], (uint8_t)val);
-      }
+    // Apply modulation to dataslots, value of 255 will not do anything
+    if (val < 255) {
+      for (int s=0; s<ANIM_DATA_SLOTS; s++)
+        if (this->dataslot[s]) animData[s] = scale16by8(animData[s], (uint8_t)val);
+    }
+    return didChange;
+  }
 
-      // Did animator produced a different result than last call ?
-      didChange = (this->_lastProducedValue != val);
-      this->_lastProducedValue = val;
+  // Execute modulation function on byte data slots (see K32_anim_typed: slot is the byte offset of a field)
+  bool run(uint8_t *animData, int size)
+  { 
+    int val;
+    bool didChange = this->step(val);
 
+    if (val < 255) {
+      for (int s=0; s<min(size, ANIM_DATA_SLOTS); s++)
+        if (this->dataslot[s]) animData[s] = scale8(animData[s], (uint8_t)val);
     }
     return didChange;
   }
 
+  // MODULATION GRAPH: last value produced, 255 (no effect) if not running
+  int output() {
+    if (!this->isRunning || this->spatial()) return 255;
+    return min(255, max(0, this->_lastProducedValue));
+  }
+
+  // MODULATION GRAPH: output of an upstream modulator (0 -> 255) scales target param for next run() only
+  void input(uint8_t target, int val) {
+    if (target >= MOD_TARGETS) return;
+    this->_depth[target] = scale8(this->_depth[target], min(255, max(0, val)));
+    this->_modulated = true;
+  }
+
   // 8Bit Direct value : Defined in SubClass ! 
   virtual int value()    { return 255; }
 
+  // Waveform level (0 -> 65535) at phase (0 -> 65535) : Defined in SubClass to be used as spatial modulator
+  virtual uint16_t shape(uint16_t phase)  { return 65535; }
+
+  // waveform scaled to mini -> maxi
+  int level(uint16_t phase) { return scale16level(shape(phase), liveAmplitude()) + liveMini(); }
+
+  // SPATIAL: spread value along anim pixels, one period every wavelength pixels (0 = off)
+  K32_modulator *wavelength(int pixels) {
+    this->edit();
+    this->_edit.wavelength = max(0, pixels);
+    return this->commit();
+  }
+  int wavelength() { return this->edited().wavelength; }
+  bool spatial() { return this->isRunning && this->_live.wavelength > 0; }
+
+  // SPATIAL: modulator value (0 -> 255) of count pixels, starting at anim pixel first
+  void spread(uint8_t* scale, int first, int count) 
+  {
+    uint32_t step = 65536 / this->_live.wavelength;
+    uint16_t phase = progress16() - first * step;
+    for (int i = 0; i < count; i++) {
+      int val = level(phase);
+      scale[i] = min(255, max(0, val));
+      phase -= step;
+    }
+  }
+
+  // EDIT: group several setters in one update, seen all at once by the render task
+  //   mod->edit()->period(500)->phase(90)->maxi(200)->commit();
+  // each setter alone is also a complete edit / commit
+  K32_modulator *edit() 
+  {
+    xSemaphoreTakeRecursive(this->editLock, portMAX_DELAY);
+    this->_editDepth += 1;
+    return this;
+  }
+
+  K32_modulator *commit() 
+  {
+    this->_editDepth -= 1;
+    if (this->_editDepth == 0) {
+      uint32_t seq = this->_seq.load(std::memory_order_relaxed);
+      this->_seq.store(seq + 1, std::memory_order_relaxed);           // odd: publish in progress
+      std::atomic_thread_fence(std::memory_order_release);
+      this->_shared = this->_edit;
+      this->_seq.store(seq + 2, std::memory_order_release);
+    }
+    xSemaphoreGiveRecursive(this->editLock);
+    return this;
+  }
+
   // change one Params
   K32_modulator *param(int k, int value)
   {
     if (k < MOD_PARAMS_SLOTS)
     {
-      // xSemaphoreTake(this->paramInUse, portMAX_DELAY);
-      this->params[k] = value;
-      // xSemaphoreGive(this->paramInUse);
+      this->edit();
+      this->_edit.params[k] = value;
+      this->commit();
     }
     return this;
   }
 
   // set special params
   K32_modulator *mini(int m) {
-    this->_mini = m;
-    return this;
+    this->edit();
+    this->_edit.mini = m;
+    return this->commit();
   }
   K32_modulator *maxi(int m) {
-    this->_maxi = m;
-    return this;
+    this->edit();
+    this->_edit.maxi = m;
+    return this->commit();
   }
   K32_modulator *period(int p) {
-    this->_period = p;
-    return this;
+    this->edit();
+    this->_edit.period = p;
+    return this->commit();
   }
   K32_modulator *phase(int p) {
-    this->_phase = p;
-    return this;
+    this->edit();
+    this->_edit.phase = p;
+    return this->commit();
   }
 
   // TOOLS
   //
 
-  // get special params
-  int mini() { return this->_mini; }
-  int maxi() { return this->_maxi; }
-  int amplitude() { return this->_maxi - this->_mini; }
-  int period() { return max(1, this->_period); }
-  int phase() { return this->_phase; }
+  // get special params (as last set, render task may not have loaded them yet)
+  int mini() { return this->edited().mini; }
+  int maxi() { return this->edited().maxi; }
+  int amplitude() { modParams p = this->edited(); return p.maxi - p.mini; }
+  int period() { return max(1, this->edited().period); }
+  int phase() { return this->edited().phase; }
 
-  virtual int time() { return (this->freezeTime > 0) ? this->freezeTime : millis(); }
-  float progress() { return 1.0 * (time() % period()) / period(); }
-  int periodCount() { return time() / period(); }
+  // show time (ms): synced between nodes when a master sends /clock beacons (see K32_clock)
+  virtual int time() { return (this->freezeTime > 0) ? this->freezeTime : showClock().now(); }
+
+  // OSCILLATOR: position of time() in period
+  int position() { oscillate(); return this->_oscPos; }                                  // time() % livePeriod() in ms
+  uint16_t progress16() { oscillate(); return (this->_oscPos * this->_oscStep) >> 16; }    // progress on 0 -> 65535
+  float progress() { return progress16() / 65536.0f; }                                   // progress on 0.0 -> 1.0
+  int periodCount() { oscillate(); return this->_oscCount; }                             // time() / livePeriod()
 
   bool fresh() {
     bool r = this->_fresh;
@@ -166,33 +264,40 @@ public:
   //
 
   K32_modulator *faster() { 
-    this->_period = max(1, (int)(this->_period/1.2)); 
-    //LOG(this->_period);
-    return this;
+    this->edit();
+    this->_edit.period = max(1, (int)(this->_edit.period/1.2)); 
+    return this->commit();
   }
   K32_modulator *slower() { 
-    this->_period *= 1.2; 
-    return this;
+    this->edit();
+    this->_edit.period *= 1.2; 
+    return this->commit();
   }
   K32_modulator *bigger() { 
-    this->_maxi = min(255, (int)(this->_maxi*1.2));
-    return this;
+    this->edit();
+    this->_edit.maxi = min(255, (int)(this->_edit.maxi*1.2));
+    return this->commit();
   }
   K32_modulator *smaller() { 
-    this->_maxi = max(0, (int)(this->_maxi/1.2));
-    return this;
+    this->edit();
+    this->_edit.maxi = max(0, (int)(this->_edit.maxi/1.2));
+    return this->commit();
   }
 
 
 protected:
 
-  int params[MOD_PARAMS_SLOTS];
+  // params used by the render task: last loaded snapshot, modulated by graph inputs (see apply())
+  // read only in value() / shape(): the next load() overwrites them, users change them with param()
+  modParams _live;
+  int* const params = _live.params;
 
-  // common params
-  int _period = 1000;
-  int _phase = 0;
-  int _mini = 0;
-  int _maxi = 255;
+  // RENDER: special params as used by value() / shape() (see _live)
+  int liveMini() { return this->_live.mini; }
+  int liveMaxi() { return this->_live.maxi; }
+  int liveAmplitude() { return this->_live.maxi - this->_live.mini; }
+  int livePeriod() { return max(1, this->_live.period); }
+  int livePhase() { return this->_live.phase; }
 
   // time refs
   unsigned long freezeTime = 0;
@@ -202,12 +307,145 @@ protected:
 
 private:
 
-  SemaphoreHandle_t paramInUse;
+  // params edited by users, then published to the render task (seqlock)
+  SemaphoreHandle_t editLock;
+  int _editDepth = 0;
+  modParams _edit;
+  modParams _shared;
+  std::atomic<uint32_t> _seq {0};
+  uint32_t _baseSeq = 0;
+  modParams _base;
+
+  // USERS: copy of edited params
+  modParams edited() {
+    xSemaphoreTakeRecursive(this->editLock, portMAX_DELAY);
+    modParams p = this->_edit;
+    xSemaphoreGiveRecursive(this->editLock);
+    return p;
+  }
+
+  // graph inputs of current frame, per target (255 = unchanged)
+  uint8_t _depth[MOD_TARGETS];
+  bool _modulated = false;
+  bool _liveModulated = false;
+
+  // RENDER: copy last published params into _base, lock-free, returns true if they changed
+  // if a commit is in progress, keep the previous snapshot: it will be picked up next frame
+  bool load() 
+  {
+    uint32_t seq = this->_seq.load(std::memory_order_acquire);
+    if (seq == this->_baseSeq || (seq & 1)) return false;
+    modParams p = this->_shared;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (this->_seq.load(std::memory_order_relaxed) != seq) return false;
+    if (p.period != this->_base.period) this->_oscAnchor = true;
+    this->_base = p;
+    this->_baseSeq = seq;
+    return true;
+  }
+
+  // RENDER: _live = _base scaled by graph inputs, then inputs are consumed
+  void apply() 
+  {
+    this->_live = this->_base;
+    this->_liveModulated = this->_modulated;
+    if (!this->_modulated) return;
+
+    for (int t=0; t<MOD_TARGETS; t++)
+      if (this->_depth[t] < 255) {
+        int& v = field(this->_live, t);
+        v = ((int64_t)v * (this->_depth[t] + 1)) >> 8;
+        this->_depth[t] = 255;
+      }
+    this->_modulated = false;
+  }
+
+  static int& field(modParams& p, int target) 
+  {
+    switch (target) {
+      case MOD_PERIOD:      return p.period;
+      case MOD_WAVELENGTH:  return p.wavelength;
+      case MOD_PHASE:       return p.phase;
+      case MOD_MINI:        return p.mini;
+      case MOD_MAXI:        return p.maxi;
+      default:              return p.params[target - MOD_PARAM];
+    }
+  }
+
   String _name = "?";
   bool isRunning = false;
 
   bool dataslot[ANIM_DATA_SLOTS];
   int _lastProducedValue = 0;
+
+  // oscillator state
+  bool _oscAnchor = false;    // period set by user: back to time() % period (same phase on every node)
+  int _oscPeriod = 0;
+  uint32_t _oscStep = 0;      // 2^32 / period: position -> progress16 without division
+  int _oscTime = 0;
+  int _oscPos = 0;
+  int _oscCount = 0;
+
+  // Get modulator value (255 if not running), returns true if it changed since last call
+  bool step(int& val) 
+  {
+    val = 255;
+
+    if (this->load() || this->_modulated || this->_liveModulated) this->apply();
+
+    // Spatial: applied on pixels by anim (see K32_anim::render), moves every frame
+    if (this->spatial()) return true;
+    if (!this->isRunning) return false;
+
+    // Get Modulator value, CLAMP to 0->255
+    val = this->value();
+    val = min(255, val);
+    val = max(0, val);
+
+    // Did animator produced a different result than last call ?
+    bool didChange = (this->_lastProducedValue != val);
+    this->_lastProducedValue = val;
+    return didChange;
+  }
+
+  // follow time() incrementally: no division as long as time moves forward by less than a period
+  // period set by user: position is re-anchored on time() % period (nodes sharing show time stay in phase)
+  // period driven by the modulation graph only: progress is kept continuous (swept period does not jump)
+  void oscillate() 
+  {
+    int t = time();
+    int p = livePeriod();
+    uint32_t delta = t - this->_oscTime;
+
+    if (this->_oscAnchor) {
+      this->_oscAnchor = false;
+      this->_oscPeriod = 0;
+    }
+    else if (p != this->_oscPeriod && this->_oscPeriod > 0 && delta < (uint32_t)p) {
+      this->_oscPos = ((int64_t)this->_oscPos * p) / this->_oscPeriod;
+      this->_oscPeriod = p;
+      this->_oscStep = 0xFFFFFFFFu / p;
+    }
+
+    if (p == this->_oscPeriod && delta < (uint32_t)p) {
+      this->_oscPos += delta;
+      if (this->_oscPos >= p) {
+        this->_oscPos -= p;
+        this->_oscCount += 1;
+      }
+    }
+    else {
+      this->_oscPeriod = p;
+      this->_oscStep = 0xFFFFFFFFu / p;
+      this->_oscCount = t / p;
+      this->_oscPos = t % p;
+      if (this->_oscPos < 0) {
+        this->_oscPos += p;
+        this->_oscCount -= 1;
+      }
+    }
+    this->_oscTime = t;
+  }
 };
 
 
@@ -216,10 +454,10 @@ private:
 class K32_modulator_periodic : public K32_modulator {
   public:
 
-    // Time is shifted with phase (0->360°) * period()
+    // Time is shifted with phase (0->360°) * livePeriod()
     virtual int time() 
     {
-      return K32_modulator::time() - ((this->_phase % 360) * this->_period) / 360;
+      return K32_modulator::time() - ((this->_live.phase % 360) * this->_live.period) / 360;
     }
 
 };
@@ -234,7 +472,7 @@ class K32_modulator_trigger : public K32_modulator {
     // Time is shifted with phase as fixed delay
     virtual int time() 
     {
-      return K32_modulator::time() - this->triggerTime - this->_phase;
+      return K32_modulator::time() - this->triggerTime - this->_live.phase;
     }
 
 };
@@ -0,0 +1,75 @@
+#ifndef __INC_BLEND_H
+#define __INC_BLEND_H
+
+/*
+    Layer blending on pixelColor_t spans, one 32-bit word (4 channels) per step
+    (except multiply: per channel, see pixelMultiply)
+    Written by: Thomas BOHL for KXKM / MIT license / 2026
+*/
+
+#include "swar.h"
+
+enum blendMode : uint8_t {
+    BLEND_OVER,         // layer replaces what is below, black is transparent
+    BLEND_ALPHA,        // crossfade with what is below (opacity is the mix)
+    BLEND_ADD,          // saturating add
+    BLEND_MAX,          // brightest channel wins
+    BLEND_MULTIPLY      // layer is a mask: below * layer / 256
+};
+
+/// scale8(a, b) on each channel: not a packed op, each lane has its own multiplier (4 multiplies)
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelMultiply( uint32_t a, uint32_t b)
+{
+    pixelColor_t pa, pb, r; pa.num = a; pb.num = b;
+    r.r = scale8(pa.r, pb.r);
+    r.g = scale8(pa.g, pb.g);
+    r.b = scale8(pa.b, pb.b);
+    r.w = scale8(pa.w, pb.w);
+    return r.num;
+}
+
+/// a + (b-a) * frac / 256 on each channel, frac is 0 -> 256
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelMix( uint32_t a, uint32_t b, uint16_t frac)
+{
+    uint16_t keep = 256 - frac;
+    uint32_t even = (((a & LANES_EVEN) * keep + (b & LANES_EVEN) * frac) >> 8) & LANES_EVEN;
+    uint32_t odd = (((a >> 8) & LANES_EVEN) * keep + ((b >> 8) & LANES_EVEN) * frac) & ~LANES_EVEN;
+    return even | odd;
+}
+
+/// black is transparent
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelOver( uint32_t a, uint32_t b)
+{
+    return b ? b : a;
+}
+
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelAlpha( uint32_t a, uint32_t b)
+{
+    return b;
+}
+
+// blend src onto dst, then mix result with dst by frac (0 -> 256)
+template<uint32_t (*op)(uint32_t, uint32_t)>
+LIB8STATIC void blendLoop( pixelColor_t* dst, const pixelColor_t* src, int count, uint16_t frac)
+{
+    if (frac >= 256)
+        for (int i = 0; i < count; i++) dst[i].num = op(dst[i].num, src[i].num);
+    else if (frac > 0)
+        for (int i = 0; i < count; i++) dst[i].num = pixelMix(dst[i].num, op(dst[i].num, src[i].num), frac);
+}
+
+/// blend count pixels of src layer onto dst with mode, at opacity (0 -> 255)
+LIB8STATIC void blendSpan( pixelColor_t* dst, const pixelColor_t* src, int count, blendMode mode, uint8_t opacity)
+{
+    uint16_t frac = opacity + (opacity >> 7);     // 255 -> 256: full opacity is exact
+
+    switch (mode) {
+        case BLEND_OVER:        blendLoop<pixelOver>(dst, src, count, frac);       break;
+        case BLEND_ALPHA:       blendLoop<pixelAlpha>(dst, src, count, frac);      break;
+        case BLEND_ADD:         blendLoop<pixelAdd>(dst, src, count, frac);        break;
+        case BLEND_MAX:         blendLoop<pixelMax>(dst, src, count, frac);        break;
+        case BLEND_MULTIPLY:    blendLoop<pixelMultiply>(dst, src, count, frac);   break;
+    }
+}
+
+#endif
@@ -68,6 +68,15 @@ struct CRGBW {
         w = rhs.w;
     }
 
+    /// allow construction from _librmt pixel
+	inline CRGBW(const pixelColor_t& pixel) __attribute__((always_inline))
+    {
+        r = pixel.r;
+        g = pixel.g;
+        b = pixel.b;
+        w = pixel.w;
+    }
+
     /// allow construction from 32-bit (really 24-bit) 0xRRGGBB color code
 	inline CRGBW(uint32_t colorcode) __attribute__((always_inline))
     {
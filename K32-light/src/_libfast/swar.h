@@ -0,0 +1,195 @@
+#ifndef __INC_SWAR_H
+#define __INC_SWAR_H
+
+/*
+    Packed color math: a pixelColor_t is handled as one 32-bit word, 4 channels at once
+    (SIMD within a register). Every word op gives the exact same result as the
+    per-channel lib8tion function named in its comment.
+    Define LIBFAST_SCALAR to use the per-channel reference instead.
+    Written by: Thomas BOHL for KXKM / MIT license / 2026
+*/
+
+#include "pixel.h"
+#include "math8.h"
+
+#define LANES_EVEN  0x00FF00FFu     // r, b: two 16 bits lanes with 8 bits headroom (g, w once shifted by 8)
+#define LANES_ONE   0x01000100u     // 0x100 in each 16 bits lane: borrow guard
+#define BYTES_HIGH  0x80808080u
+#define BYTES_LOW   0x7F7F7F7Fu
+
+
+#ifndef LIBFAST_SCALAR
+
+/// qadd8 on each channel
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelAdd( uint32_t a, uint32_t b)
+{
+    uint32_t sum = (a & BYTES_LOW) + (b & BYTES_LOW);
+    sum ^= (a ^ b) & BYTES_HIGH;
+    uint32_t carry = ((a & b) | ((a | b) & ~sum)) & BYTES_HIGH;
+    return sum | ((carry >> 7) * 0xFF);
+}
+
+// 0xFF in lanes where a >= b (a, b are LANES_EVEN masked)
+LIB8STATIC_ALWAYS_INLINE uint32_t lanesGreaterEqual( uint32_t a, uint32_t b)
+{
+    return ((((a | LANES_ONE) - b) >> 8) & 0x00010001u) * 0xFF;
+}
+
+/// max on each channel
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelMax( uint32_t a, uint32_t b)
+{
+    uint32_t ae = a & LANES_EVEN,         be = b & LANES_EVEN;
+    uint32_t ao = (a >> 8) & LANES_EVEN,  bo = (b >> 8) & LANES_EVEN;
+    uint32_t me = lanesGreaterEqual(ae, be);
+    uint32_t mo = lanesGreaterEqual(ao, bo);
+    return ((ae & me) | (be & ~me)) | (((ao & mo) | (bo & ~mo)) << 8);
+}
+
+/// min on each channel
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelMin( uint32_t a, uint32_t b)
+{
+    uint32_t ae = a & LANES_EVEN,         be = b & LANES_EVEN;
+    uint32_t ao = (a >> 8) & LANES_EVEN,  bo = (b >> 8) & LANES_EVEN;
+    uint32_t me = lanesGreaterEqual(ae, be);
+    uint32_t mo = lanesGreaterEqual(ao, bo);
+    return ((be & me) | (ae & ~me)) | (((bo & mo) | (ao & ~mo)) << 8);
+}
+
+/// nscale8x4 (scale8 on each channel)
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelScale( uint32_t a, uint8_t scale)
+{
+    uint16_t s = scale + 1;
+    return (((a & LANES_EVEN) * s >> 8) & LANES_EVEN) | (((a >> 8) & LANES_EVEN) * s & ~LANES_EVEN);
+}
+
+/// nscale8x4_video (scale8_video on each channel: non zero stays non zero)
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelScaleVideo( uint32_t a, uint8_t scale)
+{
+    uint32_t scaled = (((a & LANES_EVEN) * scale >> 8) & LANES_EVEN) | (((a >> 8) & LANES_EVEN) * scale & ~LANES_EVEN);
+    if (scale == 0) return scaled;
+    uint32_t nonzero = ((((a & BYTES_LOW) + BYTES_LOW) | a) & BYTES_HIGH) >> 7;
+    return scaled + nonzero;
+}
+
+// lerp8by8 on 2 lanes (a, b are LANES_EVEN masked)
+LIB8STATIC_ALWAYS_INLINE uint32_t lanesLerp( uint32_t a, uint32_t b, uint16_t frac1)
+{
+    uint32_t up = lanesGreaterEqual(b, a);
+    uint32_t delta = ((((b | LANES_ONE) - a) & up) | (((a | LANES_ONE) - b) & ~up)) & LANES_EVEN;
+    uint32_t scaled = (delta * frac1 >> 8) & LANES_EVEN;
+    return ((((a + scaled) & up) | (((a | LANES_ONE) - scaled) & ~up)) & LANES_EVEN);
+}
+
+/// lerp8by8 on each channel: a -> b
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelLerp( uint32_t a, uint32_t b, fract8 frac)
+{
+    uint16_t f = frac + 1;
+    return lanesLerp(a & LANES_EVEN, b & LANES_EVEN, f) | (lanesLerp((a >> 8) & LANES_EVEN, (b >> 8) & LANES_EVEN, f) << 8);
+}
+
+#else
+
+// REFERENCE: per channel lib8tion
+
+#define PIXEL_EACH(a, b, expr)  pixelColor_t pa, pb, r; pa.num = a; pb.num = b; \
+    r.r = expr(pa.r, pb.r); r.g = expr(pa.g, pb.g); r.b = expr(pa.b, pb.b); r.w = expr(pa.w, pb.w); return r.num;
+
+LIB8STATIC_ALWAYS_INLINE uint8_t max8( uint8_t a, uint8_t b) { return (a > b) ? a : b; }
+LIB8STATIC_ALWAYS_INLINE uint8_t min8( uint8_t a, uint8_t b) { return (a < b) ? a : b; }
+
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelAdd( uint32_t a, uint32_t b) { PIXEL_EACH(a, b, qadd8) }
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelMax( uint32_t a, uint32_t b) { PIXEL_EACH(a, b, max8) }
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelMin( uint32_t a, uint32_t b) { PIXEL_EACH(a, b, min8) }
+
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelScale( uint32_t a, uint8_t scale)
+{
+    pixelColor_t p; p.num = a;
+    nscale8x4(p.r, p.g, p.b, p.w, scale);
+    return p.num;
+}
+
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelScaleVideo( uint32_t a, uint8_t scale)
+{
+    pixelColor_t p; p.num = a;
+    nscale8x4_video(p.r, p.g, p.b, p.w, scale);
+    return p.num;
+}
+
+LIB8STATIC_ALWAYS_INLINE uint32_t pixelLerp( uint32_t a, uint32_t b, fract8 frac)
+{
+    pixelColor_t pa, pb, r; pa.num = a; pb.num = b;
+    r.r = lerp8by8(pa.r, pb.r, frac); r.g = lerp8by8(pa.g, pb.g, frac);
+    r.b = lerp8by8(pa.b, pb.b, frac); r.w = lerp8by8(pa.w, pb.w, frac);
+    return r.num;
+}
+
+#endif
+
+
+///////////////////////////////////////////////////////////////////////
+//
+// SPANS: count pixels, in place on dst
+//
+
+/// dst = dst * scale (nscale8)
+LIB8STATIC void spanScale( pixelColor_t* dst, int count, uint8_t scale)
+{
+    if (scale == 255) return;
+    for (int i = 0; i < count; i++) dst[i].num = pixelScale(dst[i].num, scale);
+}
+
+/// dst[i] = dst[i] * scale[i] (nscale8 by pixel)
+LIB8STATIC void spanScale( pixelColor_t* dst, const uint8_t* scale, int count)
+{
+    for (int i = 0; i < count; i++) dst[i].num = pixelScale(dst[i].num, scale[i]);
+}
+
+/// dst = dst % scale (nscale8_video: master dimming)
+LIB8STATIC void spanScaleVideo( pixelColor_t* dst, int count, uint8_t scale)
+{
+    for (int i = 0; i < count; i++) dst[i].num = pixelScaleVideo(dst[i].num, scale);
+}
+
+/// dst = src % scale (nscale8_video copy)
+LIB8STATIC void spanScaleVideo( pixelColor_t* dst, const pixelColor_t* src, int count, uint8_t scale)
+{
+    for (int i = 0; i < count; i++) dst[i].num = pixelScaleVideo(src[i].num, scale);
+}
+
+/// dst = dst fadeToBlackBy fade
+LIB8STATIC void spanFade( pixelColor_t* dst, int count, uint8_t fade)
+{
+    spanScale(dst, count, 255 - fade);
+}
+
+/// dst = dst += src (qadd8)
+LIB8STATIC void spanAdd( pixelColor_t* dst, const pixelColor_t* src, int count)
+{
+    for (int i = 0; i < count; i++) dst[i].num = pixelAdd(dst[i].num, src[i].num);
+}
+
+/// dst = max(dst, src)
+LIB8STATIC void spanMax( pixelColor_t* dst, const pixelColor_t* src, int count)
+{
+    for (int i = 0; i < count; i++) dst[i].num = pixelMax(dst[i].num, src[i].num);
+}
+
+/// dst = min(dst, src)
+LIB8STATIC void spanMin( pixelColor_t* dst, const pixelColor_t* src, int count)
+{
+    for (int i = 0; i < count; i++) dst[i].num = pixelMin(dst[i].num, src[i].num);
+}
+
+/// dst = dst.lerp8(src, frac): crossfade
+LIB8STATIC void spanLerp( pixelColor_t* dst, const pixelColor_t* src, int count, fract8 frac)
+{
+    for (int i = 0; i < count; i++) dst[i].num = pixelLerp(dst[i].num, src[i].num, frac);
+}
+
+/// dst = color
+LIB8STATIC void spanFill( pixelColor_t* dst, int count, pixelColor_t color)
+{
+    for (int i = 0; i < count; i++) dst[i] = color;
+}
+
+#endif
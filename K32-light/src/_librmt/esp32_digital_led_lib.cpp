@@ -35,6 +35,7 @@
 
 
 #include "esp32_digital_led_lib.h"
+#include "rmt_encoder.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -136,31 +137,34 @@ const uint8_t gamma8_table[] = {
  192,194,196,198,200,202,204,206,208,210,212,214,216,218,220,222,
  224,226,228,230,232,234,236,238,240,242,245,247,249,251,253,255 };
 
-typedef union {
-  struct {
-    uint32_t duration0:15;
-    uint32_t level0:1;
-    uint32_t duration1:15;
-    uint32_t level1:1;
-  };
-  uint32_t val;
-} rmtPulsePair;
-
 typedef struct {
-  uint8_t * buf_data;
-  uint16_t buf_pos, buf_len, buf_half, buf_isDirty;
-  xSemaphoreHandle sem;
-  rmtPulsePair pulsePairMap[2];
+  rmtTx_t tx;           // transmission buffer and pulse encoding (see rmt_encoder.h)
+  uint8_t gamma;
+  uint8_t order[4];     // see colorOrderAll
+  uint8_t balance[4];   // r, g, b, w
+  uint8_t lut[4][256];  // r, g, b, w output values: gamma * brightLimit * balance
 } digitalLeds_stateData;
 
 static strand_t localStrands[8];
 static int localStrandCnt = 0;
 
 static intr_handle_t rmt_intr_handle = nullptr;
+static SemaphoreHandle_t tx_done[8];          // one per RMT channel, given by ISR on tx_end (no timer task deferral)
+
+// Byte encoders, one per distinct timing
+typedef struct {
+  uint32_t bit0, bit1;
+  rmtPulsePair * map;
+} byteEncoder_t;
+
+static byteEncoder_t byteEncoders[8];
+static int byteEncoderCnt = 0;
 
 // Forward declarations of local functions
 static void copyToRmtBlock_half(strand_t * pStrand);
+static int loadPixels(strand_t * pStrand);
 static void handleInterrupt(void *arg);
+static void buildLut(strand_t * pStrand);
 
 uint8_t gamma8(uint8_t value)
 {
@@ -168,6 +172,128 @@ uint8_t gamma8(uint8_t value)
   //return gamma8_table[value];
 }
 
+static uint8_t gammaCurve(int gamma, uint8_t value)
+{
+  if (gamma == GAMMA_22) return gamma8_table[value];
+  if (gamma == GAMMA_LINEAR) return value;
+  return gamma8(value);
+}
+
+// Precompute output value of every channel, so that packing is a single lookup per byte
+static void buildLut(strand_t * pStrand)
+{
+  digitalLeds_stateData * pState = static_cast<digitalLeds_stateData*>(pStrand->_stateVars);
+
+  if (pStrand->brightLimit < 0) pStrand->brightLimit = 0;
+  if (pStrand->brightLimit > 255) pStrand->brightLimit = 255;
+
+  for (int c = 0; c < 4; c++) 
+    for (int v = 0; v < 256; v++) 
+      pState->lut[c][v] = (uint32_t)gammaCurve(pState->gamma, v) * pStrand->brightLimit * pState->balance[c] / (255*255);
+}
+
+void digitalLeds_setGamma(strand_t * pStrand, int gamma)
+{
+  digitalLeds_stateData * pState = static_cast<digitalLeds_stateData*>(pStrand->_stateVars);
+  pState->gamma = gamma;
+  buildLut(pStrand);
+}
+
+void digitalLeds_setBrightness(strand_t * pStrand, int brightLimit)
+{
+  pStrand->brightLimit = brightLimit;
+  buildLut(pStrand);
+}
+
+void digitalLeds_setBalance(strand_t * pStrand, uint8_t red, uint8_t green, uint8_t blue, uint8_t white)
+{
+  digitalLeds_stateData * pState = static_cast<digitalLeds_stateData*>(pStrand->_stateVars);
+  pState->balance[0] = red;
+  pState->balance[1] = green;
+  pState->balance[2] = blue;
+  pState->balance[3] = white;
+  buildLut(pStrand);
+}
+
+// Returns -1 (order unchanged) if order is not a color_order
+int digitalLeds_setColorOrder(strand_t * pStrand, int order)
+{
+  if (order < 0 || order >= (int)(sizeof(colorOrderAll) / sizeof(colorOrderAll[0]))) return -1;
+  digitalLeds_stateData * pState = static_cast<digitalLeds_stateData*>(pStrand->_stateVars);
+  memcpy(pState->order, colorOrderAll[order], 4);
+  return 0;
+}
+
+// Pre-encode every byte value into its 8 RMT pulses: the ISR refill becomes a plain copy
+// Tables are built once per timing and shared between strands (8KB each)
+int digitalLeds_setEncoder(strand_t * pStrand, int enable)
+{
+  digitalLeds_stateData * pState = static_cast<digitalLeds_stateData*>(pStrand->_stateVars);
+
+  if (!enable) {
+    pState->tx.byteMap = nullptr;
+    return 0;
+  }
+
+  for (int e = 0; e < byteEncoderCnt; e++)
+    if (byteEncoders[e].bit0 == pState->tx.pulsePairMap[0].val && byteEncoders[e].bit1 == pState->tx.pulsePairMap[1].val) {
+      pState->tx.byteMap = byteEncoders[e].map;
+      return 0;
+    }
+
+  if (byteEncoderCnt >= 8) return -1;
+
+  rmtPulsePair * map = static_cast<rmtPulsePair*>(malloc(256 * 8 * sizeof(rmtPulsePair)));
+  if (map == nullptr) return -1;
+
+  rmtBuildByteMap(map, pState->tx.pulsePairMap);
+
+  byteEncoders[byteEncoderCnt].bit0 = pState->tx.pulsePairMap[0].val;
+  byteEncoders[byteEncoderCnt].bit1 = pState->tx.pulsePairMap[1].val;
+  byteEncoders[byteEncoderCnt].map = map;
+  byteEncoderCnt += 1;
+
+  pState->tx.byteMap = map;
+  return 0;
+}
+
+// RMT memory blocks used by a strand (its own block + chained ones)
+static int memBlocks(strand_t * pStrand)
+{
+  digitalLeds_stateData * pState = static_cast<digitalLeds_stateData*>(pStrand->_stateVars);
+  if (pState == nullptr) return 1;
+  return pState->tx.maxPulses * 2 / RMT_BLOCK_PULSES;
+}
+
+// Chain RMT memory blocks: channel n with k blocks also uses the memory of channels n+1..n+k-1,
+// which then can't be used by another strand. blocks = 0: take every block up to the next strand.
+// Returns the number of blocks used, -1 if it would overlap another strand.
+// Must not be called while the strand is transmitting.
+int digitalLeds_setMemBlocks(strand_t * pStrand, int blocks)
+{
+  digitalLeds_stateData * pState = static_cast<digitalLeds_stateData*>(pStrand->_stateVars);
+  int channel = pStrand->rmtChannel;
+
+  // first channel used by a strand above this one
+  int limit = 8;
+  for (int i = 0; i < localStrandCnt; i++) {
+    int other = localStrands[i].rmtChannel;
+    if (other > channel && other < limit) limit = other;
+
+    // a strand below may already chain over this channel
+    if (other < channel && other + memBlocks(&localStrands[i]) > channel) return -1;
+  }
+
+  if (blocks <= 0) blocks = limit - channel;
+  if (channel + blocks > limit) return -1;
+
+  pState->tx.maxPulses = blocks * RMT_BLOCK_PULSES / 2;
+  RMT.conf_ch[channel].conf0.mem_size = blocks;
+  RMT.tx_lim_ch[channel].limit = pState->tx.maxPulses;
+
+  return blocks;
+}
+
 int digitalLeds_init() 
 {
   DPORT_SET_PERI_REG_MASK(DPORT_PERIP_CLK_EN_REG, DPORT_RMT_CLK_EN);
@@ -176,14 +302,23 @@ int digitalLeds_init()
   RMT.apb_conf.fifo_mask = 1;       // Enable memory access, instead of FIFO mode
   RMT.apb_conf.mem_tx_wrap_en = 1;  // Wrap around when hitting end of buffer
   
+  for (int ch = 0; ch < 8; ch++) tx_done[ch] = xSemaphoreCreateBinary();
   esp_intr_alloc(ETS_RMT_INTR_SOURCE, 0, handleInterrupt, nullptr, &rmt_intr_handle);
 
   return 0;
 }
 
+// Returns nullptr if the RMT channel is already used: by another strand, or by the chained memory blocks of a strand below
 strand_t* digitalLeds_addStrand(strand_t strands)
 {
   if (localStrandCnt >= 8) return nullptr;
+  if (strands.rmtChannel < 0 || strands.rmtChannel >= 8) return nullptr;
+
+  for (int i = 0; i < localStrandCnt; i++) {
+    int other = localStrands[i].rmtChannel;
+    if (other == strands.rmtChannel) return nullptr;
+    if (other < strands.rmtChannel && other + memBlocks(&localStrands[i]) > strands.rmtChannel) return nullptr;
+  }
 
   localStrandCnt += 1;
   localStrands[localStrandCnt-1] = strands;
@@ -203,12 +338,23 @@ strand_t* digitalLeds_addStrand(strand_t strands)
   }
   digitalLeds_stateData * pState = static_cast<digitalLeds_stateData*>(pStrand->_stateVars);
 
-  pState->buf_len = (pStrand->numPixels * ledParams.bytesPerPixel);
-  pState->buf_data = static_cast<uint8_t*>(malloc(pState->buf_len));
-  if (pState->buf_data == nullptr) {
+  pState->tx.buf_len = (pStrand->numPixels * ledParams.bytesPerPixel);
+  pState->tx.buf_data = static_cast<uint8_t*>(malloc(pState->tx.buf_len));
+  if (pState->tx.buf_data == nullptr) {
     return nullptr;
   }
 
+  pState->tx.maxPulses = MAX_PULSES;
+  pState->tx.byteMap = nullptr;
+  pState->tx.buf_isDirty = 0;
+  pState->tx.resetDuration = ledParams.TRS / (RMT_DURATION_NS * DIVIDER);
+
+  // Default output: square gamma, GRB(W), no white balance
+  pState->gamma = GAMMA_SQUARE;
+  memcpy(pState->order, colorOrderAll[ORDER_GRB], 4);
+  memset(pState->balance, 255, 4);
+  buildLut(pStrand);
+
   #if defined(ARDUINO) && ARDUINO >= 100
     pinMode(pStrand->gpioNum, OUTPUT);
     digitalWrite(pStrand->gpioNum, LOW);
@@ -238,19 +384,19 @@ strand_t* digitalLeds_addStrand(strand_t strands)
   RMT.conf_ch[pStrand->rmtChannel].conf1.idle_out_en = 1;
   RMT.conf_ch[pStrand->rmtChannel].conf1.idle_out_lv = 0;
 
-  RMT.tx_lim_ch[pStrand->rmtChannel].limit = MAX_PULSES;
+  RMT.tx_lim_ch[pStrand->rmtChannel].limit = pState->tx.maxPulses;
 
   // RMT config for transmitting a '0' bit val to this LED strand
-  pState->pulsePairMap[0].level0 = 1;
-  pState->pulsePairMap[0].level1 = 0;
-  pState->pulsePairMap[0].duration0 = ledParams.T0H / (RMT_DURATION_NS * DIVIDER);
-  pState->pulsePairMap[0].duration1 = ledParams.T0L / (RMT_DURATION_NS * DIVIDER);
+  pState->tx.pulsePairMap[0].level0 = 1;
+  pState->tx.pulsePairMap[0].level1 = 0;
+  pState->tx.pulsePairMap[0].duration0 = ledParams.T0H / (RMT_DURATION_NS * DIVIDER);
+  pState->tx.pulsePairMap[0].duration1 = ledParams.T0L / (RMT_DURATION_NS * DIVIDER);
 
   // RMT config for transmitting a '0' bit val to this LED strand
-  pState->pulsePairMap[1].level0 = 1;
-  pState->pulsePairMap[1].level1 = 0;
-  pState->pulsePairMap[1].duration0 = ledParams.T1H / (RMT_DURATION_NS * DIVIDER);
-  pState->pulsePairMap[1].duration1 = ledParams.T1L / (RMT_DURATION_NS * DIVIDER);
+  pState->tx.pulsePairMap[1].level0 = 1;
+  pState->tx.pulsePairMap[1].level1 = 0;
+  pState->tx.pulsePairMap[1].duration0 = ledParams.T1H / (RMT_DURATION_NS * DIVIDER);
+  pState->tx.pulsePairMap[1].duration1 = ledParams.T1L / (RMT_DURATION_NS * DIVIDER);
 
   RMT.int_ena.val |= tx_thr_event_offsets[pStrand->rmtChannel];  // RMT.int_ena.ch<n>_tx_thr_event = 1;
   RMT.int_ena.val |= tx_end_offsets[pStrand->rmtChannel];  // RMT.int_ena.ch<n>_tx_end = 1;
@@ -262,38 +408,79 @@ strand_t* digitalLeds_addStrand(strand_t strands)
 
 
 int IRAM_ATTR digitalLeds_updatePixels(strand_t * pStrand)
+{
+  return digitalLeds_drawPixels(&pStrand, 1);
+}
+
+// Load every strand first, then start all RMT channels together and wait for all of them
+int IRAM_ATTR digitalLeds_drawPixels(strand_t ** strands, int count)
+{
+  static portMUX_TYPE startMux = portMUX_INITIALIZER_UNLOCKED;
+  uint32_t channels = 0;
+
+  for (int s = 0; s < count; s++) {
+    if (loadPixels(strands[s]) < 0) continue;
+    channels |= (1 << strands[s]->rmtChannel);
+  }
+  if (!channels) return -1;
+
+  for (int s = 0; s < count; s++)
+    if (channels & (1 << strands[s]->rmtChannel)) xSemaphoreTake(tx_done[strands[s]->rmtChannel], 0);   // stale tx_end
+
+  portENTER_CRITICAL(&startMux);
+  for (int s = 0; s < count; s++)
+    if (channels & (1 << strands[s]->rmtChannel)) {
+      RMT.conf_ch[strands[s]->rmtChannel].conf1.mem_rd_rst = 1;
+      RMT.conf_ch[strands[s]->rmtChannel].conf1.tx_start = 1;
+    }
+  portEXIT_CRITICAL(&startMux);
+
+  for (int s = 0; s < count; s++)
+    if (channels & (1 << strands[s]->rmtChannel)) xSemaphoreTake(tx_done[strands[s]->rmtChannel], portMAX_DELAY);
+
+  return 0;
+}
+
+// Pack pixels and prefill channel memory, ready to start
+static int IRAM_ATTR loadPixels(strand_t * pStrand)
 {
   digitalLeds_stateData * pState = static_cast<digitalLeds_stateData*>(pStrand->_stateVars);
   ledParams_t ledParams = ledParamsAll[pStrand->ledType];
 
-  // Pack pixels into transmission buffer
+  // Pack pixels into transmission buffer: color order + LUT (gamma, brightness, balance)
+  const uint8_t * pixels = reinterpret_cast<const uint8_t*>(pStrand->pixels);
+  uint8_t * out = pState->tx.buf_data;
+  const uint8_t o0 = pState->order[0], o1 = pState->order[1], o2 = pState->order[2], o3 = pState->order[3];
+  const uint8_t * lut0 = pState->lut[o0];
+  const uint8_t * lut1 = pState->lut[o1];
+  const uint8_t * lut2 = pState->lut[o2];
+  const uint8_t * lut3 = pState->lut[o3];
+
   if (ledParams.bytesPerPixel == 3) {
-    for (uint16_t i = 0; i < pStrand->numPixels; i++) {
-      // Color order is translated from RGB to GRB
-      pState->buf_data[0 + i * 3] = gamma8(pStrand->pixels[i].g);
-      pState->buf_data[1 + i * 3] = gamma8(pStrand->pixels[i].r);
-      pState->buf_data[2 + i * 3] = gamma8(pStrand->pixels[i].b);
+    for (uint16_t i = 0; i < pStrand->numPixels; i++, pixels += 4, out += 3) {
+      out[0] = lut0[pixels[o0]];
+      out[1] = lut1[pixels[o1]];
+      out[2] = lut2[pixels[o2]];
     }
   }
   else if (ledParams.bytesPerPixel == 4) {
-    for (uint16_t i = 0; i < pStrand->numPixels; i++) {
-      // Color order is translated from RGBW to GRBW
-      pState->buf_data[0 + i * 4] = gamma8(pStrand->pixels[i].g);
-      pState->buf_data[1 + i * 4] = gamma8(pStrand->pixels[i].r);
-      pState->buf_data[2 + i * 4] = gamma8(pStrand->pixels[i].b);
-      pState->buf_data[3 + i * 4] = gamma8(pStrand->pixels[i].w);
+    for (uint16_t i = 0; i < pStrand->numPixels; i++, pixels += 4, out += 4) {
+      out[0] = lut0[pixels[o0]];
+      out[1] = lut1[pixels[o1]];
+      out[2] = lut2[pixels[o2]];
+      out[3] = lut3[pixels[o3]];
     }
   }
   else {
     return -1;
   }
 
-  pState->buf_pos = 0;
-  pState->buf_half = 0;
+  pState->tx.buf_pos = 0;
+  pState->tx.buf_half = 0;
 
   copyToRmtBlock_half(pStrand);
 
-  if (pState->buf_pos < pState->buf_len) {
+  if (pState->tx.buf_pos < pState->tx.buf_len) {
     // Fill the other half of the buffer block
     #if DEBUG_ESP32_DIGITAL_LED_LIB
       snprintf(digitalLeds_debugBuffer, digitalLeds_debugBufferSz,
@@ -302,15 +489,6 @@ int IRAM_ATTR digitalLeds_updatePixels(strand_t * pStrand)
     copyToRmtBlock_half(pStrand);
   }
 
-  pState->sem = xSemaphoreCreateBinary();
-
-  RMT.conf_ch[pStrand->rmtChannel].conf1.mem_rd_rst = 1;
-  RMT.conf_ch[pStrand->rmtChannel].conf1.tx_start = 1;
-
-  xSemaphoreTake(pState->sem, portMAX_DELAY);
-  vSemaphoreDelete(pState->sem);
-  pState->sem = nullptr;
-
   return 0;
 }
 
@@ -320,78 +498,11 @@ static IRAM_ATTR void copyToRmtBlock_half(strand_t * pStrand)
   // When wraparound is happening, we want to keep the inactive half of the RMT block filled
 
   digitalLeds_stateData * pState = static_cast<digitalLeds_stateData*>(pStrand->_stateVars);
-  ledParams_t ledParams = ledParamsAll[pStrand->ledType];
-
-  uint16_t i, j, offset, len, byteval;
-
-  offset = pState->buf_half * MAX_PULSES;
-  pState->buf_half = !pState->buf_half;
-
-  len = pState->buf_len - pState->buf_pos;
-  if (len > (MAX_PULSES / 8))
-    len = (MAX_PULSES / 8);
-
-  if (!len) {
-    if (!pState->buf_isDirty) {
-      return;
-    }
-    // Clear the channel's data block and return
-    for (i = 0; i < MAX_PULSES; i++) {
-      RMTMEM.chan[pStrand->rmtChannel].data32[i + offset].val = 0;
-    }
-    pState->buf_isDirty = 0;
-    return;
-  }
-  pState->buf_isDirty = 1;
-
-  for (i = 0; i < len; i++) {
-    byteval = pState->buf_data[i + pState->buf_pos];
 
-    #if DEBUG_ESP32_DIGITAL_LED_LIB
-      snprintf(digitalLeds_debugBuffer, digitalLeds_debugBufferSz,
-               "%s%d(", digitalLeds_debugBuffer, byteval);
-    #endif
-
-    // Shift bits out, MSB first, setting RMTMEM.chan[n].data32[x] to
-    // the rmtPulsePair value corresponding to the buffered bit value
-    for (j = 0; j < 8; j++, byteval <<= 1) {
-      int bitval = (byteval >> 7) & 0x01;
-      int data32_idx = i * 8 + offset + j;
-      RMTMEM.chan[pStrand->rmtChannel].data32[data32_idx].val = pState->pulsePairMap[bitval].val;
-      #if DEBUG_ESP32_DIGITAL_LED_LIB
-        snprintf(digitalLeds_debugBuffer, digitalLeds_debugBufferSz,
-                 "%s%d", digitalLeds_debugBuffer, bitval);
-      #endif
-    }
-    #if DEBUG_ESP32_DIGITAL_LED_LIB
-      snprintf(digitalLeds_debugBuffer, digitalLeds_debugBufferSz,
-               "%s) ", digitalLeds_debugBuffer);
-    #endif
-
-    // Handle the reset bit by stretching duration1 for the final bit in the stream
-    if (i + pState->buf_pos == pState->buf_len - 1) {
-      RMTMEM.chan[pStrand->rmtChannel].data32[i * 8 + offset + 7].duration1 =
-        ledParams.TRS / (RMT_DURATION_NS * DIVIDER);
-      #if DEBUG_ESP32_DIGITAL_LED_LIB
-        snprintf(digitalLeds_debugBuffer, digitalLeds_debugBufferSz,
-                 "%sRESET ", digitalLeds_debugBuffer);
-      #endif
-    }
-  }
-
-  // Clear the remainder of the channel's data not set above
-  for (i *= 8; i < MAX_PULSES; i++) {
-    RMTMEM.chan[pStrand->rmtChannel].data32[i + offset].val = 0;
-  }
-
-  pState->buf_pos += len;
-
-  #if DEBUG_ESP32_DIGITAL_LED_LIB
-    snprintf(digitalLeds_debugBuffer, digitalLeds_debugBufferSz,
-             "%s ", digitalLeds_debugBuffer);
-  #endif
+  // chained blocks are contiguous: index past the first block of the channel
+  volatile rmtPulsePair * mem = reinterpret_cast<volatile rmtPulsePair*>(&RMTMEM.chan[pStrand->rmtChannel].data32[0]);
 
-  return;
+  rmtFillHalf(&pState->tx, mem);
 }
 
 static IRAM_ATTR void handleInterrupt(void *arg)
@@ -405,23 +516,20 @@ static IRAM_ATTR void handleInterrupt(void *arg)
 
   for (int i = 0; i < localStrandCnt; i++) {
     strand_t * pStrand = &localStrands[i];
-    digitalLeds_stateData * pState = static_cast<digitalLeds_stateData*>(pStrand->_stateVars);
 
     if (RMT.int_st.val & tx_thr_event_offsets[pStrand->rmtChannel])
     {  // tests RMT.int_st.ch<n>_tx_thr_event
       copyToRmtBlock_half(pStrand);
       RMT.int_clr.val |= tx_thr_event_offsets[pStrand->rmtChannel];  // set RMT.int_clr.ch<n>_tx_thr_event
     }
-    else if (RMT.int_st.val & tx_end_offsets[pStrand->rmtChannel] && pState->sem)
-    {  // tests RMT.int_st.ch<n>_tx_end and semaphore
-      xSemaphoreGiveFromISR(pState->sem, &xHigherPriorityTaskWoken);
+    else if (RMT.int_st.val & tx_end_offsets[pStrand->rmtChannel])
+    {  // tests RMT.int_st.ch<n>_tx_end
+      // pdFALSE: already given, nobody took the previous tx_end (strand added before any draw): nothing to wake
+      xSemaphoreGiveFromISR(tx_done[pStrand->rmtChannel], &xHigherPriorityTaskWoken);
       RMT.int_clr.val |= tx_end_offsets[pStrand->rmtChannel];  // set RMT.int_clr.ch<n>_tx_end
-      if (xHigherPriorityTaskWoken == pdTRUE)
-      {
-          portYIELD_FROM_ISR();
-      }
     }
   }
 
-  return;
+  if (xHigherPriorityTaskWoken == pdTRUE)
+    portYIELD_FROM_ISR();
 }
@@ -98,11 +98,50 @@ extern "C"
       [LED_SK6812W_V1] = {.bytesPerPixel = 4, .T0H = 300, .T1H = 600, .T0L = 900, .T1L = 600, .TRS = 80000}, // R V B W
   };
 
+  enum led_gamma
+  {
+    GAMMA_SQUARE,   // v*v/255 (default)
+    GAMMA_22,       // gamma 2.2 table
+    GAMMA_LINEAR,
+  };
+
+  enum color_order
+  {
+    ORDER_GRB,      // default
+    ORDER_RGB,
+    ORDER_BRG,
+    ORDER_RBG,
+    ORDER_GBR,
+    ORDER_BGR,
+  };
+
+  const uint8_t colorOrderAll[][4] = {
+      // Byte index in pixelColor_t (r=0, g=1, b=2, w=3) of each transmitted byte, W always last
+      // Still must match order of `color_order`
+      [ORDER_GRB] = {1, 0, 2, 3},
+      [ORDER_RGB] = {0, 1, 2, 3},
+      [ORDER_BRG] = {2, 0, 1, 3},
+      [ORDER_RBG] = {0, 2, 1, 3},
+      [ORDER_GBR] = {1, 2, 0, 3},
+      [ORDER_BGR] = {2, 1, 0, 3},
+  };
+
   
   extern int digitalLeds_init();
   extern strand_t* digitalLeds_addStrand(strand_t strands);
   extern int digitalLeds_updatePixels(strand_t *strand);
+  extern int digitalLeds_drawPixels(strand_t **strands, int count);
   extern void digitalLeds_resetPixels(strand_t *pStrand);
+
+  // Output calibration: rebuild strand LUT (gamma * brightLimit * white balance)
+  extern void digitalLeds_setGamma(strand_t *pStrand, int gamma);
+  extern void digitalLeds_setBrightness(strand_t *pStrand, int brightLimit);
+  extern void digitalLeds_setBalance(strand_t *pStrand, uint8_t red, uint8_t green, uint8_t blue, uint8_t white);
+  extern int digitalLeds_setColorOrder(strand_t *pStrand, int order);
+
+  // ISR load: pre-encoded bytes (byte -> 8 pulses table) and chained RMT memory blocks
+  extern int digitalLeds_setEncoder(strand_t *pStrand, int enable);
+  extern int digitalLeds_setMemBlocks(strand_t *pStrand, int blocks);
   
   
 
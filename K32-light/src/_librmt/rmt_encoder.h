@@ -0,0 +1,90 @@
+/*
+    RMT pulse encoding of a strand transmission buffer, half of the channel memory at a time
+    Used by the RMT interrupt (esp32_digital_led_lib.cpp) and by host benchmarks / refill simulation (host/k32rmt.cpp)
+    Written by: Thomas BOHL for KXKM / MIT license / 2026
+*/
+
+#ifndef RMT_ENCODER_H
+#define RMT_ENCODER_H
+
+#include <stdint.h>
+
+#define RMT_BLOCK_PULSES  64      // Pulses per RMT memory block, a channel can chain up to 8 blocks
+#define RMT_INLINE        static inline __attribute__((always_inline))   // called from IRAM interrupt
+
+typedef union {
+  struct {
+    uint32_t duration0:15;
+    uint32_t level0:1;
+    uint32_t duration1:15;
+    uint32_t level1:1;
+  };
+  uint32_t val;
+} rmtPulsePair;
+
+typedef struct {
+  uint8_t * buf_data;
+  uint16_t buf_pos, buf_len, buf_half, buf_isDirty;
+  uint16_t maxPulses;           // half of channel memory, refilled per interrupt
+  uint16_t resetDuration;       // last bit low time: reset / latch
+  rmtPulsePair pulsePairMap[2];
+  const rmtPulsePair * byteMap; // optional: 8 pulses per byte value (256*8), shared with same timings
+} rmtTx_t;
+
+// Fill the next half of channel memory (chained blocks are contiguous) with the next bytes of buf_data
+// When wraparound is happening, we want to keep the inactive half of the RMT block filled:
+// past the end, the half is cleared once (zero pulse ends the transmission)
+RMT_INLINE void rmtFillHalf(rmtTx_t * tx, volatile rmtPulsePair * mem)
+{
+  uint16_t i, j, len, byteval;
+  const uint16_t maxPulses = tx->maxPulses;
+
+  mem += tx->buf_half * maxPulses;
+  tx->buf_half = !tx->buf_half;
+
+  len = tx->buf_len - tx->buf_pos;
+  if (len > (maxPulses / 8))
+    len = (maxPulses / 8);
+
+  if (!len) {
+    if (!tx->buf_isDirty) return;
+    for (i = 0; i < maxPulses; i++) mem[i].val = 0;
+    tx->buf_isDirty = 0;
+    return;
+  }
+  tx->buf_isDirty = 1;
+
+  for (i = 0; i < len; i++) {
+    byteval = tx->buf_data[i + tx->buf_pos];
+
+    // Pre-encoded: copy the 8 pulses of this byte value
+    if (tx->byteMap) {
+      const rmtPulsePair * pulses = &tx->byteMap[byteval * 8];
+      volatile rmtPulsePair * dest = &mem[i * 8];
+      for (j = 0; j < 8; j++) dest[j].val = pulses[j].val;
+    }
+
+    // Shift bits out, MSB first
+    else for (j = 0; j < 8; j++, byteval <<= 1)
+      mem[i * 8 + j].val = tx->pulsePairMap[(byteval >> 7) & 0x01].val;
+  }
+
+  // Handle the reset bit by stretching duration1 for the final bit in the stream
+  if (tx->buf_pos + len == tx->buf_len)
+    mem[len * 8 - 1].duration1 = tx->resetDuration;
+
+  // Clear the remainder of the channel's data not set above
+  for (i = len * 8; i < maxPulses; i++) mem[i].val = 0;
+
+  tx->buf_pos += len;
+}
+
+// Pre-encode every byte value into its 8 pulses (map: 256 * 8 pulses)
+RMT_INLINE void rmtBuildByteMap(rmtPulsePair * map, const rmtPulsePair * pulsePairMap)
+{
+  for (int byteval = 0; byteval < 256; byteval++)
+    for (int j = 0; j < 8; j++)
+      map[byteval * 8 + j].val = pulsePairMap[(byteval >> (7 - j)) & 0x01].val;
+}
+
+#endif
@@ -24,36 +24,30 @@ class K32_anim_test : public K32_anim {
       this->loop(false);
     }
 
-    // Loop
+    // Loop: one color per stage
     void draw (int data[ANIM_DATA_SLOTS])
     {
       int stepMS = data[0];
 
-      // RED
-      //
-
-      this->all( CRGBW{255,0,0} );
-      this->pause(stepMS);
+      switch (this->stage()) 
+      {
+        // RED
+        case 0: this->all( CRGBW{255,0,0} );    break;
 
+        // GREEN
+        case 1: this->all( CRGBW{0,255,0} );    break;
 
-      // GREEN 
-      //
-
-      this->all( CRGBW{0,255,0} );
-      this->pause(stepMS);
+        // BLUE
+        case 2: this->all( CRGBW{0,0,255} );    break;
 
-      // BLUE 
-      //
+        // WHITE
+        case 3: this->all( CRGBW{0,0,0,255} );  break;
 
-      this->all( CRGBW{0,0,255} );
+        default: 
+          this->clear();
+          return;
+      }
       this->pause(stepMS);
-
-      // WHITE 
-      //
-      this->all( CRGBW{0,0,0,255} );
-      this->pause(stepMS);
-
-      this->clear();
     };
 };
 
@@ -61,16 +55,20 @@ class K32_anim_test : public K32_anim {
 //
 // FULLCOLOR
 //
-class K32_anim_color : public K32_anim {
+struct colorParams {
+  uint8_t r, g, b, w;
+} __attribute__((packed));
+
+class K32_anim_color : public K32_anim_typed<colorParams> {
   public:
 
     // Setup
     void init() {}
 
     // Loop
-    void draw(int data[ANIM_DATA_SLOTS])
+    void draw(colorParams& p)
     {
-      CRGBW color {data[0], data[1], data[2], data[3]};
+      CRGBW color {p.r, p.g, p.b, p.w};
       this->all( color );
     };
 };
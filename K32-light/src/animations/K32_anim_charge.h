@@ -23,37 +23,16 @@ class K32_anim_discharge : public K32_anim {
       int& powerValue  = data[1];   // Power value (0 - 300)
 
       int length = this->size();
+      int stepMS = max(400 - powerValue*2,50);
+      int blinks = powerValue/100+3;
 
       CRGBW color1 = CRGBW{0, 100, 0};
       CRGBW color2 = CRGBW{100, 75, 0};
-      
-      for (int i=0; i<length; i ++)
-      {
-        /* First color below SOC */
-        if(i<((stateCharge*length/100)/4))
-          this->pixel(i,color1);
-  
-        else if ((i>=length/2-(stateCharge*length/100)/4)&&(i<length/2 + (stateCharge*length/100)/4))
-          this->pixel(i,color1);
-         
-        else if (i>=length-(stateCharge*length/100)/4)
-          this->pixel(i,color1);
-        
-        else /* Second color */
-          this->pixel(i,color2);
-        
-      }
-
-      /* Fleche Mode */
-      this->pixel( (stateCharge*length/100)/4, color1);
-      this->pixel( length - (stateCharge*length/100)/4 - 1, color1);
 
-      vTaskDelay(pdMS_TO_TICKS(max(400 - powerValue*2,50) ));
-
-      /* Blinking */
-      for (int i=0; i<=powerValue/100+3; i ++)
+      /* Blinking: one step per stage */
+      if (this->stage() > 0 && this->stage() <= blinks+1) 
       {
-        
+        int i = this->stage()-1;
 
         /* Normal mode */
         // this->pixel( (stateCharge*length/100)/4-1 - i , color2);
@@ -65,17 +44,43 @@ class K32_anim_discharge : public K32_anim {
         this->pixel( length/2-(stateCharge*length/100)/4 + i, color2);
         this->pixel( length/2 + (stateCharge*length/100)/4-1-i, color2);
 
-        vTaskDelay(pdMS_TO_TICKS(max(400 - powerValue*2,50) ));
+        this->pause(stepMS);
+        return;
       }
 
       /* Leds OFFs */
-      if (stateCharge > 0) {
-        if (millis() > (this->startTime+stateCharge*1000)) {
-          this->clear();
-          this->loop(false);
+      if (this->stage() > 0) {
+        if (stateCharge > 0) {
+          if (millis() > (this->startTime+stateCharge*1000)) {
+            this->clear();
+            this->loop(false);
+          }
         }
+        return;
       }
+      
+      this->map(0, length, [&](int i, CRGBW c)
+      {
+        /* First color below SOC */
+        if(i<((stateCharge*length/100)/4))
+          return color1;
+  
+        else if ((i>=length/2-(stateCharge*length/100)/4)&&(i<length/2 + (stateCharge*length/100)/4))
+          return color1;
+         
+        else if (i>=length-(stateCharge*length/100)/4)
+          return color1;
+        
+        else /* Second color */
+          return color2;
+        
+      });
+
+      /* Fleche Mode */
+      this->pixel( (stateCharge*length/100)/4, color1);
+      this->pixel( length - (stateCharge*length/100)/4 - 1, color1);
 
+      this->pause(stepMS);
     };
 };
 
@@ -91,49 +96,54 @@ class K32_anim_charge : public K32_anim {
       int& powerValue  = data[1];   // Power value (0 - 300)
 
       int length = this->size();
+      int stepMS = max(800 - powerValue*2,50);
+      int blinks = powerValue/100+1;
 
       CRGBW color1 = CRGBW(0, 100, 0);
       CRGBW color2 = CRGBW(165, 110, 0);
 
-      for (int i=0; i<length; i ++)
+      /* Blinking: one step per stage */
+      if (this->stage() > 0) 
+      {
+        if (this->stage() > blinks+1) return;
+        int i = this->stage()-1;
+
+        /* Normal mode */
+        // this->pixel( (stateCharge*length/100)/4 + i, color1);
+        // this->pixel( length - (stateCharge*length/100)/4 -1 - i, color1);
+
+        /* Fleche mode */
+        this->pixel( (stateCharge*length/100)/4 -1 + i, color1);
+        this->pixel( length - (stateCharge*length/100)/4  - i, color1);
+        this->pixel( length/2-(stateCharge*length/100)/4 - 1 - i, color1);
+        this->pixel( length/2 + (stateCharge*length/100)/4 + i, color1);
+
+        this->pause(stepMS);
+        return;
+      }
+
+      this->map(0, length, [&](int i, CRGBW c)
       {
         /* First color below SOC */
         if(i<(stateCharge*length/100)/4)
-          this->pixel(i,color1);
+          return color1;
         
         else if ((i>=length/2-(stateCharge*length/100)/4)&&(i<length/2 + (stateCharge*length/100)/4))
-          this->pixel(i,color1);
+          return color1;
         
         else if (i>=length-(stateCharge*length/100)/4)
-          this->pixel(i,color1);
+          return color1;
         
         else /* Second color */
-          this->pixel(i,color2);
+          return color2;
         
-      }
+      });
 
       /* Fleche mode */
       this->pixel( (stateCharge*length/100)/4 -1, color2);
       this->pixel( length - (stateCharge*length/100)/4, color2);
 
-      vTaskDelay(pdMS_TO_TICKS(max(800 - powerValue*2,50) ));
-
-      /* Blinking */
-      for (int i=0; i<=powerValue/100+1; i ++)
-      {
-        /* Normal mode */
-        // this->pixel( (stateCharge*length/100)/4 + i, color1);
-        // this->pixel( length - (stateCharge*length/100)/4 -1 - i, color1);
-
-        /* Fleche mode */
-        this->pixel( (stateCharge*length/100)/4 -1 + i, color1);
-        this->pixel( length - (stateCharge*length/100)/4  - i, color1);
-        this->pixel( length/2-(stateCharge*length/100)/4 - 1 - i, color1);
-        this->pixel( length/2 + (stateCharge*length/100)/4 + i, color1);
-
-        vTaskDelay(pdMS_TO_TICKS(max(800 - powerValue*2,50)));
-      }
-
+      this->pause(stepMS);
     };
 };
 
@@ -19,17 +19,21 @@
 class K32_elp : public K32_fixture 
 {
   public:
-    K32_elp(const int DMX_PIN[3], int addressStart, int size) : K32_fixture(size)
+    K32_elp(K32_dmx* dmx, int addressStart, int size) : K32_fixture(size)
     {
       // ADDR offset
       _addressStart = max(1,addressStart);
-      _dmxOut = new K32_dmx(DMX_PIN, DMX_OUT); // TODO make DMX device external (not in fixture so multiple fixture can use a single DMX out)
+      _dmxOut = dmx;
+      this->rate(DMX_FPS);
     }
 
+    K32_elp(const int DMX_PIN[3], int addressStart, int size) : K32_elp(K32_dmx::output(DMX_PIN), addressStart, size) {}
+
     // COPY Buffers to STRAND
     void show() {
       xSemaphoreTake(this->show_lock, portMAX_DELAY);
       xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
+      this->flip();
       if (this->_dirty) 
       {
         // LOGINL("show buffer // ");
@@ -37,22 +41,21 @@ class K32_elp : public K32_fixture
         // LOG(this->_buffer[0].r);
 
         /////////////////////////////////////////////////////////////////////////////////
-        int buffDMX[size()*3];
-        for (int i = 0; i < size(); i++) {
-          buffDMX[i*3]    = _buffer[i].r;
-          buffDMX[i*3+1]  = _buffer[i].g;
-          buffDMX[i*3+2]  = _buffer[i].b;
-        }   
-        this->_dmxOut->setMultiple(buffDMX, size()*3, _addressStart);
+        if (this->_dmxOut) this->_dmxOut->setPixels(_buffer, size(), 3, _addressStart);
         /////////////////////////////////////////////////////////////////////////////////
 
-        this->_dirty = false;
+        this->clean();
         xSemaphoreGive(this->draw_lock);
       }
       else xSemaphoreGive(this->show_lock);
       xSemaphoreGive(this->buffer_lock);
     }
 
+    // PUSH shared universe (once per frame, see K32_light::show)
+    void flush() {
+      if (this->_dmxOut) this->_dmxOut->flush();
+    }
+
 
   private:
     K32_dmx* _dmxOut = nullptr;
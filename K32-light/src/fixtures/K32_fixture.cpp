@@ -7,9 +7,23 @@
 #include "K32_fixture.h"
 #include <class/K32_module.h>
 
+#define FRAME_FRESH 0x80    // _ready flag: published frame not yet picked up by show()
+#define FRAME_INDEX 0x03
+
+TaskHandle_t& renderTask() {
+  static TaskHandle_t task = NULL;
+  return task;
+}
+
+void renderWake() {
+  TaskHandle_t task = renderTask();
+  if (task && task != xTaskGetCurrentTaskHandle()) xTaskNotifyGive(task);
+}
+
 K32_fixture::K32_fixture(int size) {
 
   this->buffer_lock = xSemaphoreCreateMutex();
+  this->frame_lock = xSemaphoreCreateMutex();
   this->draw_lock = xSemaphoreCreateBinary();
   this->show_lock = xSemaphoreCreateBinary();
   xSemaphoreTake(this->draw_lock, 1);
@@ -17,6 +31,7 @@ K32_fixture::K32_fixture(int size) {
 
   if (size == 0) size = FIXTURE_MAXPIXEL;
   this->_size = size;
+  this->_dirtyStart = size;
 
   this->_buffer = static_cast<pixelColor_t*>(malloc(this->_size * sizeof(pixelColor_t)));
 
@@ -36,12 +51,19 @@ int K32_fixture::size() {
   return this->_size;
 }
 
+// Buffered: lock only excludes other drawers, show() keeps running on the front frame
 void K32_fixture::lock() {
-  xSemaphoreTake(this->show_lock, portMAX_DELAY);
+  if (this->buffered()) xSemaphoreTake(this->frame_lock, portMAX_DELAY);
+  else xSemaphoreTake(this->show_lock, portMAX_DELAY);
 }
 
+// Buffered: unlock publishes the back frame to show()
 void K32_fixture::unlock() {
-  xSemaphoreGive(this->show_lock);
+  if (this->buffered()) {
+    this->publish();
+    xSemaphoreGive(this->frame_lock);
+  }
+  else xSemaphoreGive(this->show_lock);
 }
 
 bool K32_fixture::dirty() {
@@ -53,7 +75,7 @@ K32_fixture *K32_fixture::clear() {
   xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
   memset(this->_buffer, 0, this->size() * sizeof(pixelColor_t));
   // for(int i=0; i < this->size(); i++) this->_buffer[i] = {0,0,0};
-  this->_dirty = true;
+  this->markDirty(0, this->size());
   xSemaphoreGive(this->buffer_lock);
 
   return this;
@@ -68,7 +90,7 @@ K32_fixture* K32_fixture::all(pixelColor_t color) {
 
   xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
   for(int k= 0; k<this->size(); k++) this->_buffer[k] = color;
-  this->_dirty = true;
+  this->markDirty(0, this->size());
   xSemaphoreGive(this->buffer_lock);
 
   return this;
@@ -83,7 +105,7 @@ K32_fixture* K32_fixture::pix(int pixelStart, int count, pixelColor_t color) {
   xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
   for(int i = pixelStart; i<pixelStart+count; i++)
     if (i < this->size()) this->_buffer[i] = color;
-  this->_dirty = true;
+  this->markDirty(pixelStart, count);
   xSemaphoreGive(this->buffer_lock);
   return this;
 }
@@ -93,7 +115,7 @@ K32_fixture* K32_fixture::pix(int pixel, pixelColor_t color) {
   {
     xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
     this->_buffer[pixel] = color;
-    this->_dirty = true;
+    this->markDirty(pixel, 1);
     xSemaphoreGive(this->buffer_lock);
   }
   return this;
@@ -103,6 +125,92 @@ K32_fixture* K32_fixture::pix(int pixel, int red, int green, int blue, int white
   return this->pix( pixel, pixelFromRGBW(red, green, blue, white) );
 }
 
+K32_fixture* K32_fixture::pix(int pixelStart, int count, const pixelColor_t* colors) {
+  int skip = max(0, -pixelStart);
+  if (!this->clip(pixelStart, count)) return this;
+
+  xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
+  memcpy(&this->_buffer[pixelStart], &colors[skip], count * sizeof(pixelColor_t));
+  this->markDirty(pixelStart, count);
+  xSemaphoreGive(this->buffer_lock);
+  return this;
+}
+
+K32_fixture* K32_fixture::gradient(int pixelStart, int count, CRGBW from, CRGBW to) {
+  int first = pixelStart;
+  int length = count;
+  if (!this->clip(pixelStart, count)) return this;
+
+  xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
+  for (int i = pixelStart; i < pixelStart+count; i++) 
+    this->_buffer[i] = from.lerp8(to, (length > 1) ? (i-first)*255/(length-1) : 0);
+  this->markDirty(pixelStart, count);
+  xSemaphoreGive(this->buffer_lock);
+  return this;
+}
+
+// copy count pixels from src (starting at srcStart) to this fixture (starting at pixelStart)
+K32_fixture* K32_fixture::blit(K32_fixture* src, int srcStart, int count, int pixelStart) {
+  if (srcStart < 0) { count += srcStart; pixelStart -= srcStart; srcStart = 0; }
+  count = min(count, src->size() - srcStart);
+  int skip = max(0, -pixelStart);
+  if (!this->clip(pixelStart, count)) return this;
+  srcStart += skip;
+
+  // always lock in the same order to prevent deadlock with a reverse blit
+  K32_fixture* first = (src < this) ? src : this;
+  K32_fixture* second = (src < this) ? this : src;
+  xSemaphoreTake(first->buffer_lock, portMAX_DELAY);
+  if (second != first) xSemaphoreTake(second->buffer_lock, portMAX_DELAY);
+  memmove(&this->_buffer[pixelStart], &src->_buffer[srcStart], count * sizeof(pixelColor_t));
+  this->markDirty(pixelStart, count);
+  if (second != first) xSemaphoreGive(second->buffer_lock);
+  xSemaphoreGive(first->buffer_lock);
+  return this;
+}
+
+// Copy the dirty part of src span to this fixture (see K32_light routes)
+// Both buffers are locked once, returns false if nothing was copied
+// show_lock first (as show()): flip() recycles the front frame, and the copy writes into it,
+// both must wait for a push in progress from that frame (strand->pixels)
+bool K32_fixture::route(K32_fixture* src, int srcStart, int count, int pixelStart) 
+{
+  bool didCopy = false;
+
+  K32_fixture* first = (src < this) ? src : this;
+  K32_fixture* second = (src < this) ? this : src;
+  xSemaphoreTake(first->show_lock, portMAX_DELAY);
+  if (second != first) xSemaphoreTake(second->show_lock, portMAX_DELAY);
+  xSemaphoreTake(first->buffer_lock, portMAX_DELAY);
+  if (second != first) xSemaphoreTake(second->buffer_lock, portMAX_DELAY);
+
+  src->flip();
+  this->flip();
+
+  if (src->_dirty) 
+  {
+    // intersect span with src dirty range
+    int start = max(srcStart, src->_dirtyStart);
+    int stop = min(srcStart + count, src->_dirtyStop);
+    int pos = pixelStart + start - srcStart;
+    count = stop - start;
+
+    int skip = max(0, -pos);
+    if (this->clip(pos, count)) {
+      start += skip;
+      memmove(&this->_buffer[pos], &src->_buffer[start], count * sizeof(pixelColor_t));
+      this->extendDirty(pos, count);
+      didCopy = true;
+    }
+  }
+
+  if (second != first) xSemaphoreGive(second->buffer_lock);
+  xSemaphoreGive(first->buffer_lock);
+  if (second != first) xSemaphoreGive(second->show_lock);
+  xSemaphoreGive(first->show_lock);
+  return didCopy;
+}
+
 void K32_fixture::getBuffer(pixelColor_t* buffer, int _size, int offset) {
   xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
   for(int k= 0; (k<this->size() && k<_size); k++) 
@@ -114,8 +222,70 @@ void K32_fixture::setBuffer(pixelColor_t* buffer, int _size, int offset) {
   xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
   for(int k= 0; (k<this->size() && k<_size); k++) 
     this->_buffer[k+offset] = buffer[k];
-  this->_dirty = true;
+  this->markDirty(offset, _size);
+  xSemaphoreGive(this->buffer_lock);
+}
+
+// Enable / disable lock-free drawing: anims draw into a private back frame between lock() and unlock(),
+// unlock() publishes it with a single atomic exchange and show() picks it up.
+// Must be set before anims start to play. Direct pix() / all() writes still go to the front frame
+// and are overwritten by the next published frame.
+K32_fixture* K32_fixture::buffered(bool enable) 
+{
+  if (enable == this->buffered()) return this;
+
+  xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
+  if (enable) {
+    this->_frames[0] = this->_buffer;
+    for (int f=1; f<3; f++) {
+      this->_frames[f] = static_cast<pixelColor_t*>(malloc(this->_size * sizeof(pixelColor_t)));
+      memcpy(this->_frames[f], this->_buffer, this->_size * sizeof(pixelColor_t));
+    }
+    this->_front = 0;
+    this->_back = 1;
+    this->_ready = 2;
+    for (int f=0; f<3; f++) {
+      this->_frameStart[f] = this->_size;
+      this->_frameStop[f] = 0;
+    }
+  }
+  else {
+    for (int f=0; f<3; f++) 
+      if (f != this->_front) free(this->_frames[f]);
+    for (int f=0; f<3; f++) this->_frames[f] = nullptr;
+  }
   xSemaphoreGive(this->buffer_lock);
+
+  return this;
+}
+
+bool K32_fixture::buffered() {
+  return this->_frames[1] != nullptr;
+}
+
+// Slow outputs (DMX) don't need to be drawn at the leds strips rate, 
+// K32_light rounds it to a divider of its frame clock
+K32_fixture* K32_fixture::rate(int fps) {
+  this->_rate = max(0, fps);
+  return this;
+}
+
+int K32_fixture::rate() {
+  return this->_rate;
+}
+
+// Back frame: only valid between lock() and unlock(), nullptr if fixture is not buffered
+pixelColor_t* K32_fixture::frame() {
+  if (!this->buffered()) return nullptr;
+  return this->_frames[this->_back];
+}
+
+// Report back frame pixels modified since lock(), published with the frame.
+// Frames published without any touch() are considered entirely dirty.
+void K32_fixture::touch(int pixelStart, int count) {
+  if (!this->buffered()) return;
+  this->_frameStart[this->_back] = max(0, min((int)this->_frameStart[this->_back], pixelStart));
+  this->_frameStop[this->_back] = min(this->size(), max((int)this->_frameStop[this->_back], pixelStart + count));
 }
 
 // Virtual !
@@ -123,23 +293,116 @@ void K32_fixture::show()
 {
   xSemaphoreTake(this->show_lock, portMAX_DELAY);
   xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
+  this->flip();
   if (this->_dirty) {
     
     // HERE: COPY BUFFER TO OUTPUT (only executed when _dirty)
 
-    this->_dirty = false;
+    this->clean();
     xSemaphoreGive(this->draw_lock);
   }
   else xSemaphoreGive(this->show_lock);
   xSemaphoreGive(this->buffer_lock);
 }
 
+// Copy dirty buffer to strand and keep show_lock until release(), nullptr if nothing to push
+strand_t* K32_fixture::stage() 
+{
+  strand_t* strand = this->strand();
+  if (!strand) return nullptr;
+
+  xSemaphoreTake(this->show_lock, portMAX_DELAY);
+  xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
+  this->flip();
+  if (this->_dirty) {
+    strand->pixels = this->_buffer;
+    this->clean();
+  }
+  else {
+    strand = nullptr;
+    xSemaphoreGive(this->show_lock);
+  }
+  xSemaphoreGive(this->buffer_lock);
+  return strand;
+}
+
+// Staged strand has been pushed
+void K32_fixture::release() 
+{
+  xSemaphoreGive(this->show_lock);
+}
+
 // Virtual !
 void K32_fixture::draw() 
 {
   // HERE: PUSH OUTPUT (only executed when _dirty)
 }
 
+// Clip span to fixture, return false if nothing left to draw
+bool K32_fixture::clip(int& pixelStart, int& count) {
+  if (pixelStart < 0) {
+    count += pixelStart;
+    pixelStart = 0;
+  }
+  count = min(count, this->size() - pixelStart);
+  return count > 0;
+}
+
+// Swap back frame with the spare one, and keep drawing on a copy of what was just published
+void K32_fixture::publish() 
+{
+  uint8_t published = this->_back;
+
+  // previous frame not picked up yet: it will be skipped, so carry its dirty range
+  uint8_t ready = this->_ready.load();
+  if (ready & FRAME_FRESH) {
+    ready &= FRAME_INDEX;
+    if (this->_frameStart[ready] >= this->_frameStop[ready]) this->touch(0, this->size());
+    else this->touch(this->_frameStart[ready], this->_frameStop[ready] - this->_frameStart[ready]);
+  }
+
+  this->_back = this->_ready.exchange(published | FRAME_FRESH) & FRAME_INDEX;
+  renderWake();
+  memcpy(this->_frames[this->_back], this->_frames[published], this->_size * sizeof(pixelColor_t));
+  this->_frameStart[this->_back] = this->size();
+  this->_frameStop[this->_back] = 0;
+}
+
+// Pick up last published frame as front buffer (call with buffer_lock taken)
+void K32_fixture::flip() 
+{
+  if (!this->buffered() || !(this->_ready.load() & FRAME_FRESH)) return;
+
+  this->_front = this->_ready.exchange(this->_front) & FRAME_INDEX;
+  this->_buffer = this->_frames[this->_front];
+
+  if (this->_frameStart[this->_front] >= this->_frameStop[this->_front]) this->extendDirty(0, this->size());
+  else this->extendDirty(this->_frameStart[this->_front], this->_frameStop[this->_front] - this->_frameStart[this->_front]);
+}
+
+// Producer write: extend front dirty range and wake the render task (call with buffer_lock taken)
+void K32_fixture::markDirty(int pixelStart, int count) 
+{
+  this->extendDirty(pixelStart, count);
+  renderWake();
+}
+
+// Extend front dirty range, no wake: output side (flip, route) runs in render / output task
+void K32_fixture::extendDirty(int pixelStart, int count) 
+{
+  this->_dirty = true;
+  this->_dirtyStart = max(0, min(this->_dirtyStart, pixelStart));
+  this->_dirtyStop = min(this->size(), max(this->_dirtyStop, pixelStart + count));
+}
+
+// Output is up to date (call with buffer_lock taken)
+void K32_fixture::clean() 
+{
+  this->_dirty = false;
+  this->_dirtyStart = this->size();
+  this->_dirtyStop = 0;
+}
+
 void K32_fixture::task(void *parameter)
 {
   K32_fixture *that = (K32_fixture *)parameter;
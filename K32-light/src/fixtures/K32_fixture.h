@@ -9,9 +9,15 @@
 #define FIXTURE_MAXPIXEL 512
 
 #include <Arduino.h>
+#include <atomic>
 
 
 #include "_libfast/crgbw.h"
+#include "_librmt/esp32_digital_led_lib.h"
+
+// FRAME CLOCK: the render task (see K32_light) sleeps when nothing moves, any change wakes it up
+TaskHandle_t& renderTask();
+void renderWake();
 
 
 class K32_fixture {
@@ -32,16 +38,59 @@ class K32_fixture {
     K32_fixture* pix(int pixelStart, int count, pixelColor_t color);
     K32_fixture* pix(int pixel, int red, int green, int blue, int white = 0);
 
+    // SPANS (one lock per call)
+    K32_fixture* pix(int pixelStart, int count, const pixelColor_t* colors);
+    K32_fixture* gradient(int pixelStart, int count, CRGBW from, CRGBW to);
+    K32_fixture* blit(K32_fixture* src, int srcStart, int count, int pixelStart = 0);
+
+    // apply fn on each pixel of span:  pixelColor_t fn(int pixel, pixelColor_t color)
+    template<typename F> 
+    K32_fixture* map(int pixelStart, int count, F fn) 
+    {
+      if (!this->clip(pixelStart, count)) return this;
+      xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
+      for (int i = pixelStart; i < pixelStart+count; i++) this->_buffer[i] = fn(i, this->_buffer[i]);
+      this->markDirty(pixelStart, count);
+      xSemaphoreGive(this->buffer_lock);
+      return this;
+    }
+
     void getBuffer(pixelColor_t* buffer, int size, int offset=0);
     void setBuffer(pixelColor_t* buffer, int size, int offset=0);
 
+    // FRAME BUFFERS (lock-free drawing)
+    K32_fixture* buffered(bool enable);
+    bool buffered();
+    pixelColor_t* frame();
+    void touch(int pixelStart, int count);
+
+    // OUTPUT RATE: frames per second drawn and pushed by K32_light (0: master frame clock)
+    K32_fixture* rate(int fps);
+    int rate();
+
+    // ROUTING (clone / copy between fixtures)
+    bool route(K32_fixture* src, int srcStart, int count, int pixelStart);
+
     virtual void show();
+    virtual void flush() {}   // push shared output once per frame (after every show)
+
+    // SYNCHRONIZED OUTPUT (see K32_light::sync): fixtures backed by an RMT strand
+    virtual strand_t* strand() { return nullptr; }
+    strand_t* stage();
+    void release();
 
   protected:
 
     virtual void draw();
+    void flip();
+    bool clip(int& pixelStart, int& count);
+    void markDirty(int pixelStart, int count);
+    void extendDirty(int pixelStart, int count);
+    void clean();
 
     bool _dirty;
+    int _dirtyStart = 0;      // dirty range [start, stop[ of front buffer
+    int _dirtyStop = 0;
     pixelColor_t* _buffer;
     SemaphoreHandle_t buffer_lock;
     SemaphoreHandle_t show_lock;
@@ -49,8 +98,20 @@ class K32_fixture {
 
   private:
     int _size = 0;
+    int _rate = 0;
     static void task( void * parameter );
 
+    // Triple buffering: back is owned by drawing anims, front by show(), 
+    // the third frame is exchanged atomically between them.
+    pixelColor_t* _frames[3] = {nullptr, nullptr, nullptr};
+    uint8_t _back = 1;
+    uint8_t _front = 0;
+    std::atomic<uint8_t> _ready {2};
+    uint16_t _frameStart[3];  // dirty range of each frame, travels with it
+    uint16_t _frameStop[3];
+    SemaphoreHandle_t frame_lock;
+    void publish();
+
 };
 
 #endif
@@ -20,14 +20,68 @@ class K32_ledstrip : public K32_fixture
     {
       this->_strand = digitalLeds_addStrand(
         {.rmtChannel = chan, .gpioNum = pin, .ledType = type, .brightLimit = 255, .numPixels = this->size(), .pixels = nullptr, ._stateVars = nullptr});
+      if (!this->_strand) LOGF("LEDSTRIP: ERROR RMT channel %d already used (or chained by a strip below)\n", chan);
+    }
+
+    // OUTPUT CALIBRATION (applied by the RMT packer, see led_gamma / color_order)
+    K32_ledstrip* gamma(int curve) {
+      if (!this->_strand) return this;
+      xSemaphoreTake(this->show_lock, portMAX_DELAY);
+      digitalLeds_setGamma(this->_strand, curve);
+      xSemaphoreGive(this->show_lock);
+      return this;
+    }
+
+    K32_ledstrip* brightness(int limit) {
+      if (!this->_strand) return this;
+      xSemaphoreTake(this->show_lock, portMAX_DELAY);
+      digitalLeds_setBrightness(this->_strand, limit);
+      xSemaphoreGive(this->show_lock);
+      return this;
+    }
+
+    K32_ledstrip* balance(uint8_t red, uint8_t green, uint8_t blue, uint8_t white = 255) {
+      if (!this->_strand) return this;
+      xSemaphoreTake(this->show_lock, portMAX_DELAY);
+      digitalLeds_setBalance(this->_strand, red, green, blue, white);
+      xSemaphoreGive(this->show_lock);
+      return this;
+    }
+
+    K32_ledstrip* colorOrder(int order) {
+      if (!this->_strand) return this;
+      xSemaphoreTake(this->show_lock, portMAX_DELAY);
+      if (digitalLeds_setColorOrder(this->_strand, order) < 0) LOGF("LEDSTRIP: invalid color order %d\n", order);
+      xSemaphoreGive(this->show_lock);
+      return this;
+    }
+
+    // RMT LOAD: pre-encode bytes and chain memory blocks (blocks = 0: all free blocks up to next strip)
+    // fewer refill interrupts per frame, less sensitive to WiFi interrupt latency
+    K32_ledstrip* encoder(bool enable = true) {
+      if (!this->_strand) return this;
+      xSemaphoreTake(this->show_lock, portMAX_DELAY);
+      if (digitalLeds_setEncoder(this->_strand, enable) < 0) LOG("LEDSTRIP: no memory for byte encoder");
+      xSemaphoreGive(this->show_lock);
+      return this;
+    }
+
+    K32_ledstrip* memBlocks(int blocks = 0) {
+      if (!this->_strand) return this;
+      xSemaphoreTake(this->show_lock, portMAX_DELAY);
+      if (digitalLeds_setMemBlocks(this->_strand, blocks) < 0) LOG("LEDSTRIP: RMT memory blocks overlap another strip");
+      xSemaphoreGive(this->show_lock);
+      return this;
     }
 
 
     // COPY Buffers to STRAND
     void show() {
+      if (!this->_strand) return;
       // LOG("LIGHT: show in");      
       xSemaphoreTake(this->show_lock, portMAX_DELAY);
       xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
+      this->flip();
       if (this->_dirty) {
         
         // LOGINL("show buffer // ");
@@ -37,7 +91,7 @@ class K32_ledstrip : public K32_fixture
         
         memcpy(&this->_strand->pixels, &this->_buffer, sizeof(this->_buffer));
         // for(int i=0; i < this->size(); i++) this->_strand->pixels[i] = this->_buffer[i];
-        this->_dirty = false;
+        this->clean();
         // LOG("LIGHT: show _dirty");
 
         // LOGINL("show strand // ");
@@ -51,6 +105,10 @@ class K32_ledstrip : public K32_fixture
       // LOG("LIGHT: show end");
     }
 
+    strand_t* strand() {
+      return this->_strand;
+    }
+
   protected:
 
     // PUSH strand TO RMT
@@ -59,8 +117,7 @@ class K32_ledstrip : public K32_fixture
       // LOGINL("draw strand // ");
       // for(int i=0; i < this->size(); i++) LOGF(" %i", this->_strand->pixels[i].r);
       // LOG();
-      digitalLeds_updatePixels(this->_strand);           // PUSH LEDS TO RMT
-      delay(1);
+      digitalLeds_updatePixels(this->_strand);           // PUSH LEDS TO RMT (returns on tx end)
     }
 
   private:
@@ -18,17 +18,21 @@
 class K32_lyreaudio : public K32_fixture 
 {
   public:
-    K32_lyreaudio(const int DMX_PIN[3], int addressStart) : K32_fixture(LYRE_PATCHSIZE/4)
+    K32_lyreaudio(K32_dmx* dmx, int addressStart) : K32_fixture(LYRE_PATCHSIZE/4)
     {
       // ADDR offset
       _addressStart = max(1,addressStart);
-      _dmxOut = new K32_dmx(DMX_PIN, DMX_OUT); // TODO make DMX device external (not in fixture so multiple fixture can use a single DMX out)
+      _dmxOut = dmx;
+      this->rate(DMX_FPS);
     }
 
+    K32_lyreaudio(const int DMX_PIN[3], int addressStart) : K32_lyreaudio(K32_dmx::output(DMX_PIN), addressStart) {}
+
     // COPY Buffers to STRAND
     void show() {
       xSemaphoreTake(this->show_lock, portMAX_DELAY);
       xSemaphoreTake(this->buffer_lock, portMAX_DELAY);
+      this->flip();
       if (this->_dirty) 
       {
         // LOGINL("show buffer // ");
@@ -36,23 +40,21 @@ class K32_lyreaudio : public K32_fixture
         // LOG(this->_buffer[0].r);
 
         /////////////////////////////////////////////////////////////////////////////////
-        int buffDMX[size()*4];
-        for (int i = 0; i < size(); i++) {
-          buffDMX[i*4]    = _buffer[i].r;
-          buffDMX[i*4+1]  = _buffer[i].g;
-          buffDMX[i*4+2]  = _buffer[i].b;
-          buffDMX[i*4+3]  = _buffer[i].w;
-        }   
-        this->_dmxOut->setMultiple(buffDMX, size()*4, _addressStart);
+        if (this->_dmxOut) this->_dmxOut->setPixels(_buffer, size(), 4, _addressStart);
         /////////////////////////////////////////////////////////////////////////////////
 
-        this->_dirty = false;
+        this->clean();
         xSemaphoreGive(this->draw_lock);
       }
       else xSemaphoreGive(this->show_lock);
       xSemaphoreGive(this->buffer_lock);
     }
 
+    // PUSH shared universe (once per frame, see K32_light::show)
+    void flush() {
+      if (this->_dmxOut) this->_dmxOut->flush();
+    }
+
 
   private:
     K32_dmx* _dmxOut = nullptr;
@@ -83,7 +83,8 @@ esp_err_t K32_mqtt::mqtt_event(esp_mqtt_event_handle_t event)
 
             // GENERIC SUBSCRIBES (as Command)
             //
-            Orderz* newOrder = new Orderz(command);
+            Orderz* newOrder = that->order(command);
+            if (newOrder == nullptr) break;
             char* p = strtok(data, "|");
             while(p != NULL) {
               newOrder->addData(p);
@@ -294,6 +295,13 @@ void K32_mqtt::beacon(void *parameter)
       status += String("");  // SYNC erro
 
       that->publish("k32/monitor/status", status.c_str(), 0, true); 
+
+      // light profile (see K32_light::status)
+      K32_module* leds = that->k32->router->module("leds");
+      if (leds) {
+        status = String(that->k32->system->id())+"|"+leds->status();
+        that->publish("k32/monitor/leds", status.c_str()); 
+      }
     }
     vTaskDelay( xFrequency );
   }
@@ -6,6 +6,7 @@
 
 #include "K32_version.h"
 #include "K32_osc.h"
+#include <utils/K32_clock.h>
 
 #include <ESPmDNS.h>
 #include <ArduinoOTA.h>
@@ -99,6 +100,15 @@ void K32_osc::start(oscconf conf)
                   );                // core 
   }
 
+  // SHOW CLOCK master: beacons to other nodes (on their input port)
+  if (this->conf.port_in > 0 && this->conf.clockInterval > 0)
+    xTaskCreate( this->clock,           // function
+                  "osc_clock",          // server name
+                  3000,                 // stack memory
+                  (void*)this,          // args
+                  5,                    // priority: beacon delay is clock error
+                  &xHandle4             // handler
+                  );                    // core 
   
 };
 
@@ -107,9 +117,11 @@ void K32_osc::stop()
   if (xHandle1 != NULL) vTaskDelete(xHandle1);
   if (xHandle2 != NULL) vTaskDelete(xHandle2);
   if (xHandle3 != NULL) vTaskDelete(xHandle3);
+  if (xHandle4 != NULL) vTaskDelete(xHandle4);
   xHandle1 = NULL;
   xHandle2 = NULL;
   xHandle3 = NULL;
+  xHandle4 = NULL;
 
   this->udp->stop();
   this->sendSock->stop();
@@ -167,6 +179,10 @@ OSCMessage K32_osc::statusMsg() {
     // msg.add(sync_getStatus().c_str());
     msg.add(0);   // SYNC count files
     msg.add("");  // SYNC erro
+
+    // light profile (see K32_light::status)
+    K32_module* leds = k32->router->module("leds");
+    msg.add( (leds) ? leds->status().c_str() : "" );
     
     return msg;
 }
@@ -210,6 +226,30 @@ void K32_osc::beat( void * parameter ) {
 
 
 
+// thread function: show clock master, /clock [show time] broadcasted to nodes (see K32_clock)
+void K32_osc::clock( void * parameter ) {
+    K32_osc* that = (K32_osc*) parameter;
+    TickType_t xFrequency = pdMS_TO_TICKS(that->conf.clockInterval);
+    TickType_t xLastWake = xTaskGetTickCount();
+
+    while(true) 
+    {
+      if (that->wifi->isConnected()) {
+        xSemaphoreTake(that->lock, portMAX_DELAY);
+        OSCMessage msg("/clock");
+        msg.add((int32_t)showClock().now());      // stamped right before send
+        that->sendSock->beginPacket( that->wifi->broadcastIP(), that->conf.port_in );
+        msg.send(*that->sendSock);
+        that->sendSock->endPacket();
+        xSemaphoreGive(that->lock);
+      }
+      vTaskDelayUntil( &xLastWake, xFrequency );
+    }
+
+    vTaskDelete(NULL);
+}
+
+
 void K32_osc::beacon( void * parameter ) {
 
     K32_osc* that = (K32_osc*) parameter;
@@ -256,6 +296,7 @@ void K32_osc::server( void * parameter ) {
 
       size = that->udp->parsePacket();
       if (size > 0) {
+        that->received = millis();
         msg.empty();
         while (size--) msg.fill(that->udp->read());
         if (!msg.hasError()) {
@@ -263,8 +304,10 @@ void K32_osc::server( void * parameter ) {
 
           char adr[256];
           msg.getAddress(adr);
-          LOGINL("OSC: rcv  ");
-          LOG(adr);
+          if (strcmp(adr, "/clock") != 0) {      // clock beacons are too frequent to log
+            LOGINL("OSC: rcv  ");
+            LOG(adr);
+          }
 
           //
           // GENERAL PING
@@ -283,6 +326,14 @@ void K32_osc::server( void * parameter ) {
             }
           });
 
+          //
+          // SHOW CLOCK beacon (from master node, or from controller)
+          //
+          msg.dispatch("/clock", [](K32_osc* that, K32_oscmsg &msg){
+            if (that->conf.clockInterval > 0 || !msg.isInt(0)) return;     // master: ignore own / other beacons
+            showClock().beacon((uint32_t)msg.getInt(0), that->received);
+          });
+
           //
           // GENERAL INFO
           //
@@ -305,10 +356,24 @@ void K32_osc::server( void * parameter ) {
             char path[32];
             msg.getAddress(path, 1);
 
-            Orderz* newOrder = new Orderz( strchr(path, '/')+1 );
+            Orderz* newOrder = that->order( strchr(path, '/')+1 );
+            if (newOrder == nullptr) return;
             for(int k=0; k<msg.size(); k++) {
               if (msg.isInt(k))         newOrder->addData(msg.getInt(k));
-              else if (msg.isString(k)) newOrder->addData(msg.getStr(k).c_str());
+              else if (msg.isFloat(k))  newOrder->addData(msg.getFloat(k));
+              else if (msg.isString(k)) {
+                int length = min(msg.getDataLength(k), ORDERZ_ARENA);
+                char str[length];
+                msg.getString(k, str, length);
+                str[length-1] = '\0';
+                newOrder->addData(str);
+              }
+              else if (msg.isBlob(k)) {
+                int length = min(msg.getBlobLength(k), ORDERZ_ARENA);
+                uint8_t blob[length];
+                msg.getBlob(k, blob, length);
+                newOrder->addData(blob, length);
+              }
               else newOrder->addData("?");
             }
 
@@ -21,6 +21,7 @@ struct oscconf
   int port_out;
   int beatInterval;
   int statusInterval;
+  int clockInterval;    // show clock master: /clock beacon every clockInterval ms (0: follow /clock beacons)
 };
 
 class K32_osc : K32_plugin {
@@ -45,10 +46,12 @@ class K32_osc : K32_plugin {
     static void server( void * parameter );
     static void beacon( void * parameter );
     static void beat( void * parameter );
+    static void clock( void * parameter );
 
     WiFiUDP* udp;         // must be protected with lock 
     WiFiUDP* sendSock;
     IPAddress linkedIP;
+    uint32_t received = 0;  // local time of last packet (show clock beacons)
 
     oscconf conf;
 
@@ -59,6 +62,7 @@ class K32_osc : K32_plugin {
     TaskHandle_t xHandle1 = NULL;
     TaskHandle_t xHandle2 = NULL;
     TaskHandle_t xHandle3 = NULL;
+    TaskHandle_t xHandle4 = NULL;
 };
 
 // OSCMessage overload